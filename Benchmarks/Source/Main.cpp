@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 6:40:12pm
+    Author:  ridle
+
+    Benchmarks a built copy of the plugin, loaded as a VST3 the way a host loads it, so that any two builds can be compared.
+    Build this in Release, build the plugin in Release at each commit to be compared, and run this once for each build so
+    that every run starts in a fresh process:
+
+        Benchmarks path/to/MultiFaderDrone.vst3
+
+    Loading the binary is timed on its own, as that is when its static initialisers run, which is where the typefaces were
+    decoded before they were shared. The first instance is kept alive while the later ones are made, as it would be in a
+    session with many instances.
+
+    The output limiter is then timed against the render it sits at the end of, on one instance playing 100 voices.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr int numRuns = 25;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+    constexpr int blocksPerRun = 200;                                   // a little over 2 seconds of audio
+    constexpr int warmUpBlocks = (int)(10.0 * sampleRate) / blockSize;   // long enough for every voice to have faded in
+
+    double getMedian(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    double getTimeMs() { return juce::Time::getMillisecondCounterHiRes(); }
+
+    /*
+    Returns the hosted parameter with the given ID, or nullptr if the build doesn't have it
+    */
+    juce::HostedAudioProcessorParameter* findParameter(juce::AudioPluginInstance& instance, const juce::String& id)
+    {
+        for (auto* parameter : instance.getParameters())
+        {
+            if (auto* hosted = dynamic_cast<juce::HostedAudioProcessorParameter*>(parameter))
+            {
+                if (hosted->getParameterID() == id)
+                {
+                    return hosted;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+    Processes numBlocks blocks and returns how long they took in ms
+    */
+    double timeBlocks(juce::AudioPluginInstance& instance, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi, int numBlocks)
+    {
+        auto start = getTimeMs();
+        for (int block{}; block < numBlocks; block++)
+        {
+            midi.clear();
+            instance.processBlock(buffer, midi);
+        }
+        return getTimeMs() - start;
+    }
+
+    std::unique_ptr<juce::AudioPluginInstance> createInstance(juce::AudioPluginFormatManager& formats, const juce::PluginDescription& description)
+    {
+        juce::String error;
+        auto instance = formats.createPluginInstance(description, sampleRate, blockSize, error);
+        if (instance == nullptr)
+        {
+            std::cout << "Couldn't create the plugin: " << error << std::endl;
+        }
+        return instance;
+    }
+
+    /*
+    Times making instances of the plugin and opening their editors. A hosted editor is only built once it is attached to
+    a window, so each one is shown in a window while it is timed. Drawing happens later, so the time of the first paint
+    isn't included.
+    */
+    void timeStartup(juce::AudioPluginFormatManager& formats, const juce::PluginDescription& description, double loadTime)
+    {
+        auto start = getTimeMs();
+        auto firstInstance = createInstance(formats, description);
+        auto firstTime = getTimeMs() - start;
+        if (firstInstance == nullptr)
+        {
+            return;
+        }
+
+        std::vector<double> creation, editor;
+        for (int run{}; run < numRuns; run++)
+        {
+            start = getTimeMs();
+            auto instance = createInstance(formats, description);
+            creation.push_back(getTimeMs() - start);
+
+            // the window deletes the editor, and goes before the instance
+            juce::DocumentWindow window("Benchmark", juce::Colours::black, 0);
+            start = getTimeMs();
+            window.setContentOwned(instance->createEditorIfNeeded(), true);
+            window.setVisible(true);
+            editor.push_back(getTimeMs() - start);
+        }
+
+        std::cout << "Startup, in ms" << std::endl;
+        std::cout << "  load the binary:                        " << loadTime << std::endl;
+        std::cout << "  first instance:                         " << firstTime << std::endl;
+        std::cout << "  new instance, median of " << numRuns << " runs:      " << getMedian(creation) << std::endl;
+        std::cout << "  open editor, median of " << numRuns << " runs:       " << getMedian(editor) << std::endl;
+    }
+
+    /*
+    Times rendering 100 voices with the output limiter off and on, alternating between the two so that both see the same
+    machine load. Parameter changes reach the plugin with the next block, so one block is processed after each change before
+    timing starts.
+    */
+    void timeLimiter(juce::AudioPluginFormatManager& formats, const juce::PluginDescription& description)
+    {
+        auto instance = createInstance(formats, description);
+        if (instance == nullptr)
+        {
+            return;
+        }
+
+        auto* voices = findParameter(*instance, "numVoices");
+        auto* limiter = findParameter(*instance, "limiter");
+        if (voices == nullptr || limiter == nullptr)
+        {
+            std::cout << "This build has no output limiter" << std::endl;
+            return;
+        }
+
+        instance->enableAllBuses();
+        instance->prepareToPlay(sampleRate, blockSize);
+        juce::AudioBuffer<float> buffer(instance->getTotalNumOutputChannels(), blockSize);
+        juce::MidiBuffer midi;
+
+        voices->setValue(1.0f);
+        limiter->setValue(0.0f);
+        timeBlocks(*instance, buffer, midi, warmUpBlocks);
+
+        std::vector<double> withoutLimiter, withLimiter;
+        for (int run{}; run < numRuns; run++)
+        {
+            limiter->setValue(0.0f);
+            timeBlocks(*instance, buffer, midi, 1);
+            withoutLimiter.push_back(timeBlocks(*instance, buffer, midi, blocksPerRun));
+
+            limiter->setValue(1.0f);
+            timeBlocks(*instance, buffer, midi, 1);
+            withLimiter.push_back(timeBlocks(*instance, buffer, midi, blocksPerRun));
+        }
+        instance->releaseResources();
+
+        auto render = getMedian(withoutLimiter);
+        auto limited = getMedian(withLimiter);
+        auto audioMs = 1000.0 * blocksPerRun * blockSize / sampleRate;
+
+        std::cout << "Render of " << audioMs << " ms of audio with 100 voices, median of " << numRuns << " runs, in ms" << std::endl;
+        std::cout << "  limiter off:                            " << render << std::endl;
+        std::cout << "  limiter on:                             " << limited << std::endl;
+        std::cout << "  limiter cost:                           " << 100.0 * (limited - render) / render << "% of the render (budget 5%)" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    if (argc < 2)
+    {
+        std::cout << "Usage: Benchmarks path/to/MultiFaderDrone.vst3" << std::endl;
+        return 1;
+    }
+
+    juce::AudioPluginFormatManager formats;
+    formats.addDefaultFormats();
+
+    // scanning is what loads the binary, which stays loaded for the instances
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+    juce::VST3PluginFormat vst3;
+    auto start = getTimeMs();
+    vst3.findAllTypesForFile(descriptions, juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]).getFullPathName());
+    auto loadTime = getTimeMs() - start;
+    if (descriptions.isEmpty())
+    {
+        std::cout << "No plugin found at " << argv[1] << std::endl;
+        return 1;
+    }
+
+    timeStartup(formats, *descriptions[0], loadTime);
+    timeLimiter(formats, *descriptions[0]);
+    return 0;
+}
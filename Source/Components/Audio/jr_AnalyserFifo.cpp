@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    jr_AnalyserFifo.cpp
+    Created: 21 Oct 2026 10:04:52am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_AnalyserFifo.h"
+
+jr::AnalyserFifo::AnalyserFifo()
+{
+	ring.resize(capacity);
+}
+
+void jr::AnalyserFifo::prepare(double sampleRate, int samplesPerBlock)
+{
+	decimationFactor = juce::jmax(1, juce::roundToInt(sampleRate / targetSampleRate));
+	decimationCount = 0;
+	decimationSum = 0.0f;
+	analysisSampleRate = sampleRate / (double)decimationFactor;
+
+	scratch.resize((size_t)juce::jmax(1, samplesPerBlock));
+}
+
+void jr::AnalyserFifo::push(const juce::AudioBuffer<float>& buffer)
+{
+	int numChannels = buffer.getNumChannels();
+	if (numChannels == 0)
+	{
+		return;
+	}
+
+	auto channelScale = 1.0f / (float)numChannels;
+	int chunkSize = (int)scratch.size();
+
+	// hosts may send blocks bigger than promised, so work through the buffer in chunks the size of the scratch buffer
+	for (int chunkStart{}; chunkStart < buffer.getNumSamples(); chunkStart += chunkSize)
+	{
+		int numSamples = juce::jmin(chunkSize, buffer.getNumSamples() - chunkStart);
+		float* mono = scratch.data();
+
+		juce::FloatVectorOperations::copyWithMultiply(mono, buffer.getReadPointer(0, chunkStart), channelScale, numSamples);
+		for (int channel{ 1 }; channel < numChannels; channel++)
+		{
+			juce::FloatVectorOperations::addWithMultiply(mono, buffer.getReadPointer(channel, chunkStart), channelScale, numSamples);
+		}
+
+		// average each group of decimationFactor samples in place, a cheap anti-aliasing filter that is good enough for display
+		int numDecimated = 0;
+		for (int i{}; i < numSamples; i++)
+		{
+			decimationSum += mono[i];
+			if (++decimationCount == decimationFactor)
+			{
+				mono[numDecimated++] = decimationSum / (float)decimationFactor;
+				decimationSum = 0.0f;
+				decimationCount = 0;
+			}
+		}
+
+		int start1, size1, start2, size2;
+		fifo.prepareToWrite(numDecimated, start1, size1, start2, size2);
+		if (size1 > 0)
+		{
+			std::copy(mono, mono + size1, ring.data() + start1);
+		}
+		if (size2 > 0)
+		{
+			std::copy(mono + size1, mono + size1 + size2, ring.data() + start2);
+		}
+		fifo.finishedWrite(size1 + size2);
+	}
+}
+
+int jr::AnalyserFifo::pull(float* dest, int maxSamples)
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+	if (size1 > 0)
+	{
+		std::copy(ring.data() + start1, ring.data() + start1 + size1, dest);
+	}
+	if (size2 > 0)
+	{
+		std::copy(ring.data() + start2, ring.data() + start2 + size2, dest + size1);
+	}
+	fifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    jr_AnalyserFifo.h
+    Created: 21 Oct 2026 10:04:52am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+namespace jr
+{
+	/*
+	Passes a mono, decimated copy of the plugin output from the audio thread to the GUI for analysis, without locking or
+	allocating. The audio thread downmixes and decimates each block then copies it into a ring buffer; if the GUI has fallen
+	behind and the ring is full, the newest samples are dropped rather than waiting.
+
+	The ring is allocated once on construction so that prepare() can be called while the GUI is reading.
+	*/
+	class AnalyserFifo
+	{
+	public:
+		AnalyserFifo();
+
+		/*
+		Sets up decimation for the given sample rate and allocates the downmix scratch buffer. Call before playing, not while processing.
+		*/
+		void prepare(double sampleRate, int samplesPerBlock);
+
+		/*
+		Adds the average of every channel of buffer to the FIFO. Audio thread only.
+		*/
+		void push(const juce::AudioBuffer<float>& buffer);
+
+		/*
+		Copies up to maxSamples of the oldest samples into dest and returns the number copied. GUI thread only.
+		*/
+		int pull(float* dest, int maxSamples);
+
+		/*
+		Returns the sample rate of the samples in the FIFO, after decimation
+		*/
+		double getSampleRate() const { return analysisSampleRate.load(); }
+
+	private:
+		static constexpr int capacity = 16384;					// samples the ring can hold, about 0.7s after decimation
+		static constexpr double targetSampleRate = 24000.0;		// decimate towards this rate, which is plenty for the range of the drone
+
+		juce::AbstractFifo fifo{ capacity };
+		std::vector<float> ring;								// samples waiting for the GUI, indexed by fifo
+		std::vector<float> scratch;								// downmixed then decimated block
+
+		std::atomic<double> analysisSampleRate{ targetSampleRate };
+		int decimationFactor{ 1 };								// number of input samples averaged into each output sample
+		int decimationCount{ 0 };								// input samples in decimationSum so far
+		float decimationSum{ 0.0f };
+	};
+}
@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    jr_BinaryState.cpp
+    Created: 23 Oct 2026 10:14:52am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_BinaryState.h"
+
+bool jr::BinaryState::isBinaryState(const void* data, int sizeInBytes)
+{
+	if (data == nullptr || sizeInBytes < headerSize)
+	{
+		return false;
+	}
+
+	juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+	return input.readInt() == magic;
+}
+
+void jr::BinaryState::write(juce::MemoryBlock& destData, juce::AudioProcessorValueTreeState& apvts, const FaderPairs::Snapshot* snapshot,
+							const PresetMorph::Scenes* scenes, const PitchTable::Scale* scale, const juce::String& scaleDescription)
+{
+	juce::MemoryOutputStream output(destData, false);
+	output.writeInt(magic);
+	output.writeInt(version);
+
+	juce::MemoryOutputStream parameters;
+	int numParameters = 0;
+	for (auto* parameter : apvts.processor.getParameters())
+	{
+		if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+		{
+			parameters.writeString(ranged->getParameterID());
+			parameters.writeFloat(ranged->convertFrom0to1(ranged->getValue()));
+			numParameters++;
+		}
+	}
+
+	output.writeInt(parametersTag);
+	output.writeInt((int)parameters.getDataSize() + 4);
+	output.writeInt(numParameters);
+	output.write(parameters.getData(), parameters.getDataSize());
+
+	if (snapshot != nullptr)
+	{
+		output.writeInt(engineTag);
+		output.writeInt(16 + (int)snapshot->voices.size() * 26);
+		output.writeInt(snapshot->numActiveOscs);
+		output.writeInt64(snapshot->randomSeed);
+		output.writeInt((int)snapshot->voices.size());
+
+		for (auto& voice : snapshot->voices)
+		{
+			output.writeFloat(voice.oscFrequency);
+			output.writeFloat(voice.oscPhase);
+			output.writeFloat(voice.waveShape);
+			output.writeFloat(voice.lfoBaseFreq);
+			output.writeFloat(voice.lfoPhase);
+			output.writeFloat(voice.pan);
+			output.writeBool(voice.silenced);
+			output.writeBool(false);							// unused, the next trough is worked out from the LFO phase
+		}
+	}
+
+	if (scenes != nullptr)
+	{
+		output.writeInt(scenesTag);
+		output.writeInt(4 + (int)scenes->size() * sceneSize);
+		output.writeInt((int)scenes->size());
+
+		for (auto& scene : *scenes)
+		{
+			auto& firstLayer = scene.settings.layers[0];
+			output.writeBool(scene.isStored);
+			output.writeInt(firstLayer.numOscs);
+			output.writeInt(scene.settings.numPartials);
+			output.writeInt(scene.settings.engine == FaderPairs::Engine::spectral ? 1 : 0);
+			output.writeFloat(firstLayer.lfoRate);
+			output.writeFloat(firstLayer.minFreq);
+			output.writeFloat(firstLayer.maxFreq);
+			output.writeFloat(firstLayer.stereoWidth);
+			output.writeFloat(firstLayer.waveShape);
+			output.writeInt((int)scene.settings.pitchMode);
+			output.writeFloat(scene.settings.rootNote);
+
+			// the other layers follow, so that versions without them skip over them
+			for (int layer{ 1 }; layer < FaderPairs::maxNumLayers; layer++)
+			{
+				auto& layerSettings = scene.settings.layers[(size_t)layer];
+				output.writeInt(layerSettings.numOscs);
+				output.writeFloat(layerSettings.lfoRate);
+				output.writeFloat(layerSettings.minFreq);
+				output.writeFloat(layerSettings.maxFreq);
+				output.writeFloat(layerSettings.stereoWidth);
+				output.writeFloat(layerSettings.waveShape);
+			}
+		}
+	}
+
+	if (scale != nullptr && scale->size > 0)
+	{
+		juce::MemoryOutputStream description;
+		description.writeString(scaleDescription);
+
+		output.writeInt(scaleTag);
+		output.writeInt((int)description.getDataSize() + 4 + scale->size * 4);
+		output.write(description.getData(), description.getDataSize());
+		output.writeInt(scale->size);
+		for (int i{}; i < scale->size; i++)
+		{
+			output.writeFloat(scale->ratios[i]);
+		}
+	}
+}
+
+bool jr::BinaryState::readParameters(const void* data, int sizeInBytes, juce::AudioProcessorValueTreeState& apvts)
+{
+	if (!isBinaryState(data, sizeInBytes))
+	{
+		return false;
+	}
+
+	juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+	if (findSection(input, parametersTag) < 0)
+	{
+		return false;
+	}
+
+	int numParameters = input.readInt();
+	for (int i{}; i < numParameters && !input.isExhausted(); i++)
+	{
+		auto id = input.readString();
+		auto value = input.readFloat();
+
+		// parameters that have been removed since the state was saved are ignored, and new ones keep their defaults
+		if (auto* parameter = apvts.getParameter(id))
+		{
+			parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+		}
+	}
+
+	return true;
+}
+
+bool jr::BinaryState::readSnapshot(const void* data, int sizeInBytes, FaderPairs::Snapshot& snapshot)
+{
+	if (!isBinaryState(data, sizeInBytes))
+	{
+		return false;
+	}
+
+	juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+	int sectionSize = findSection(input, engineTag);
+	if (sectionSize < 16)
+	{
+		return false;
+	}
+
+	snapshot.numActiveOscs = input.readInt();
+	snapshot.randomSeed = input.readInt64();
+	int numVoices = input.readInt();
+	if (numVoices < 0 || numVoices > maxNumVoices || sectionSize < 16 + numVoices * 26)
+	{
+		return false;
+	}
+
+	snapshot.voices.resize((size_t)numVoices);
+	for (auto& voice : snapshot.voices)
+	{
+		voice.oscFrequency = input.readFloat();
+		voice.oscPhase = input.readFloat();
+		voice.waveShape = input.readFloat();
+		voice.lfoBaseFreq = input.readFloat();
+		voice.lfoPhase = input.readFloat();
+		voice.pan = input.readFloat();
+		voice.silenced = input.readBool();
+		input.skipNextBytes(1);
+	}
+
+	return true;
+}
+
+bool jr::BinaryState::readScenes(const void* data, int sizeInBytes, PresetMorph::Scenes& scenes)
+{
+	if (!isBinaryState(data, sizeInBytes))
+	{
+		return false;
+	}
+
+	juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+	int sectionSize = findSection(input, scenesTag);
+	if (sectionSize < 4)
+	{
+		return false;
+	}
+
+	// version 1 scenes were saved without their pitch settings, and scenes saved before there were layers without the other
+	// layers, which are left at their defaults
+	int numScenes = input.readInt();
+	int savedSceneSize = numScenes > 0 ? (sectionSize - 4) / numScenes : sceneSize;
+	if (numScenes < 0 || savedSceneSize < firstSceneSize)
+	{
+		return false;
+	}
+
+	// scenes beyond the number this version has are skipped
+	for (int i{}; i < juce::jmin(numScenes, (int)scenes.size()); i++)
+	{
+		auto& scene = scenes[i];
+		auto& firstLayer = scene.settings.layers[0];
+		scene.settings = FaderPairs::Settings();
+		scene.isStored = input.readBool();
+		firstLayer.numOscs = input.readInt();
+		scene.settings.numPartials = input.readInt();
+		scene.settings.engine = input.readInt() == 1 ? FaderPairs::Engine::spectral : FaderPairs::Engine::oscillators;
+		firstLayer.lfoRate = input.readFloat();
+		firstLayer.minFreq = input.readFloat();
+		firstLayer.maxFreq = input.readFloat();
+		firstLayer.stereoWidth = input.readFloat();
+		firstLayer.waveShape = input.readFloat();
+		int sizeRead = firstSceneSize;
+
+		if (savedSceneSize >= pitchSceneSize)
+		{
+			scene.settings.pitchMode = (PitchTable::Mode)juce::jlimit(0, (int)PitchTable::Mode::scala, input.readInt());
+			scene.settings.rootNote = input.readFloat();
+			sizeRead = pitchSceneSize;
+		}
+
+		if (savedSceneSize >= sceneSize)
+		{
+			for (int layer{ 1 }; layer < FaderPairs::maxNumLayers; layer++)
+			{
+				auto& layerSettings = scene.settings.layers[(size_t)layer];
+				layerSettings.numOscs = input.readInt();
+				layerSettings.lfoRate = input.readFloat();
+				layerSettings.minFreq = input.readFloat();
+				layerSettings.maxFreq = input.readFloat();
+				layerSettings.stereoWidth = input.readFloat();
+				layerSettings.waveShape = input.readFloat();
+			}
+			sizeRead = sceneSize;
+		}
+
+		input.skipNextBytes(savedSceneSize - sizeRead);
+	}
+
+	return true;
+}
+
+bool jr::BinaryState::readScale(const void* data, int sizeInBytes, PitchTable::Scale& scale, juce::String& description)
+{
+	if (!isBinaryState(data, sizeInBytes))
+	{
+		return false;
+	}
+
+	juce::MemoryInputStream input(data, (size_t)sizeInBytes, false);
+	int sectionSize = findSection(input, scaleTag);
+	if (sectionSize < 5)
+	{
+		return false;
+	}
+
+	auto sectionEnd = input.getPosition() + sectionSize;
+	auto savedDescription = input.readString();
+	int size = input.readInt();
+	if (size < 1 || size > PitchTable::maxScaleSize || input.getPosition() + size * 4 > sectionEnd)
+	{
+		return false;
+	}
+
+	PitchTable::Scale saved;
+	for (int i{}; i < size; i++)
+	{
+		saved.ratios[i] = input.readFloat();
+	}
+	saved.size = size;
+
+	scale = saved;
+	description = savedDescription;
+	return true;
+}
+
+int jr::BinaryState::findSection(juce::MemoryInputStream& input, int tag)
+{
+	// sections can be added in later versions, but a newer version may also have changed the existing ones
+	input.setPosition(4);
+	if (input.readInt() > version)
+	{
+		return -1;
+	}
+
+	while (input.getNumBytesRemaining() >= 8)
+	{
+		int sectionTag = input.readInt();
+		int sectionSize = input.readInt();
+		if (sectionSize < 0 || sectionSize > input.getNumBytesRemaining())
+		{
+			return -1;
+		}
+
+		if (sectionTag == tag)
+		{
+			return sectionSize;
+		}
+
+		input.skipNextBytes(sectionSize);
+	}
+
+	return -1;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    jr_BinaryState.h
+    Created: 23 Oct 2026 10:14:52am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "jr_FaderPairs.h"
+#include "jr_PresetMorph.h"
+#include "jr_PitchTable.h"
+
+namespace jr
+{
+	/*
+	Reads and writes the plugin state as a compact binary chunk, so that it can be recalled without building or parsing XML.
+
+	The chunk starts with a magic number and a version, followed by sections that each start with a tag and their size in bytes,
+	so that a reader can skip sections it doesn't know. The parameter section holds the ID and plain value of every parameter.
+	The optional engine section holds a FaderPairs::Snapshot, so that the drone carries on exactly where it was saved, the
+	optional scene section holds the scenes that can be morphed between, and the optional scale section holds a loaded Scala
+	scale.
+	*/
+	class BinaryState
+	{
+	public:
+		/*
+		Returns true if data starts with the magic number of a binary state chunk
+		*/
+		static bool isBinaryState(const void* data, int sizeInBytes);
+
+		/*
+		Writes the value of every parameter in apvts, and snapshot, scenes and scale if they aren't nullptr, to destData. An
+		empty scale isn't written.
+		*/
+		static void write(juce::MemoryBlock& destData, juce::AudioProcessorValueTreeState& apvts, const FaderPairs::Snapshot* snapshot,
+						  const PresetMorph::Scenes* scenes, const PitchTable::Scale* scale, const juce::String& scaleDescription);
+
+		/*
+		Sets every parameter in apvts that is found in data, notifying the host. Returns false if data isn't a binary state
+		chunk of a version that can be read.
+		*/
+		static bool readParameters(const void* data, int sizeInBytes, juce::AudioProcessorValueTreeState& apvts);
+
+		/*
+		Fills snapshot from the engine section of data. Returns false if there is no engine section, in which case the drone
+		should start afresh.
+		*/
+		static bool readSnapshot(const void* data, int sizeInBytes, FaderPairs::Snapshot& snapshot);
+
+		/*
+		Fills scenes from the scene section of data. Returns false, leaving scenes as they were, if there is no scene section.
+		*/
+		static bool readScenes(const void* data, int sizeInBytes, PresetMorph::Scenes& scenes);
+
+		/*
+		Fills scale and its description from the scale section of data. Returns false, leaving both as they were, if there is
+		no scale section.
+		*/
+		static bool readScale(const void* data, int sizeInBytes, PitchTable::Scale& scale, juce::String& description);
+
+	private:
+		static constexpr int magic = 0x5344464d;				// "MFDS" read as a little endian int
+		static constexpr int version = 2;						// 2 added the pitch settings to each scene
+		static constexpr int parametersTag = 0x534d5250;		// "PRMS"
+		static constexpr int engineTag = 0x4e474e45;			// "ENGN"
+		static constexpr int scenesTag = 0x534e4353;			// "SCNS"
+		static constexpr int scaleTag = 0x4c414353;				// "SCAL"
+		static constexpr int layerSize = 24;					// an int and five floats for each layer after the first
+		static constexpr int sceneSize = 41 + (FaderPairs::maxNumLayers - 1) * layerSize;	// stored flag, four ints, six floats and the other layers
+		static constexpr int pitchSceneSize = 41;				// the size of a scene in version 2 before there were layers
+		static constexpr int firstSceneSize = 33;				// the size of a scene in version 1
+		static constexpr int headerSize = 8;					// magic and version
+		static constexpr int maxNumVoices = 4096;				// anything larger is treated as a corrupt chunk
+
+		/*
+		Moves input to the start of the section with the given tag and returns its size, or returns -1 if there is no such section
+		or the chunk is from a newer version
+		*/
+		static int findSection(juce::MemoryInputStream& input, int tag);
+	};
+}
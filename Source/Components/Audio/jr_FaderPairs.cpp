@@ -1,9 +1,12 @@
 
 #include "jr_FaderPairs.h"
+#include "jr_OutputMeter.h"
 #include <JuceHeader.h>
 #include <vector>
+#include <algorithm>
 #include "jr_Oscillators.h"
 #include "jr_MultiWaveOsc.h"
+#include "jr_SpectralEngine.h"
 
 //=========================================//
 //************ FaderPair ******************//
@@ -13,14 +16,18 @@ void FaderPairs::RandomOsc::init(float _sampleRate, bool _silenced)
 {
 	silenced = _silenced;
 
-	masterGain.reset(_sampleRate, parent.rampTime);
-	masterGain.setCurrentAndTargetValue(0.0f);
-	masterGain.setTargetValue(silenced ? 0.0f : 1.0f);
+	fade.reset(_sampleRate, parent.rampTime);
+	fade.setImmediately(false);
+	if (!silenced)
+	{
+		fade.fadeIn(parent.fadeCurve);
+	}
 
 	lfo.setSampleRate(_sampleRate);
+	lfo.setTable(parent.resources);
 
 	lfoBaseFreq = parent.random.nextFloat();
-	lfo.setFrequency(getLfoFreqFromScale(lfoBaseFreq));
+	updateLfoFreq();
 
 	resetPan();
 	resetShape();
@@ -32,43 +39,146 @@ void FaderPairs::RandomOsc::init(float _sampleRate, bool _silenced)
 
 void FaderPairs::RandomOsc::updateSampleRate(float _sampleRate)
 {
-	masterGain.reset(_sampleRate, parent.rampTime);
+	fade.reset(_sampleRate, parent.rampTime);
 
 	lfo.setSampleRate(_sampleRate);
+	updateSamplesUntilTrough();
 
 	osc.setSampleRate(_sampleRate);
 }
 
-std::pair<float, float> FaderPairs::RandomOsc::process()
+bool FaderPairs::RandomOsc::process(juce::AudioBuffer<float>& output)
 {
-	if (masterGain.getCurrentValue() == 0.0f && waitingToRestart)
+	int numSamples = output.getNumSamples();
+	auto& parentLayer = parent.layers[(size_t)layer];
+	const float* sharedLevels = parent.levelBuffer.getReadPointer(0);
+	float* voiceOut = parent.voiceBuffer.getWritePointer(0);
+	float* fadeGains = parent.fadeBuffer.getWritePointer(0);
+	int segmentStart = 0;
+
+	// a voice that has finished fading out can't be heard, so nothing is rendered until it is started again
+	if (getIsSilenced() && !waitingToRestart)
+	{
+		currentLevel = 0.0f;
+		numMeasuredSamples += numSamples;
+		return false;
+	}
+
+	if (lfoRateVersion != parentLayer.lfoRateVersion.load())
+	{
+		updateLfoFreq();
+	}
+
+	if (glideTime != parent.glideTime.load())
 	{
-		waitingToRestart = false;
-		start();
+		glideTime = parent.glideTime.load();
+		osc.setGlideTime(glideTime);
+	}
+
+	for (int startSample{}; startSample < numSamples;)
+	{
+		if (samplesUntilTrough == 0)
+		{
+			processTrough(output, segmentStart, startSample);
+		}
+
+		// render up to whichever comes first of the LFO's next trough and the end of the fade, which is when a voice that is
+		// waiting to restart can start again
+		int endSample = startSample + juce::jmin(numSamples - startSample, samplesUntilTrough);
+		if (fade.isFading())
+		{
+			endSample = juce::jmin(endSample, startSample + fade.getSamplesUntilEnd());
+		}
+		bool fadeIsConstant = fade.fillBlock(fadeGains + startSample, endSample - startSample);
+
+		if (fadeIsConstant && parentLayer.levelIsConstant)
+		{
+			// neither the level nor the fade moves, so only the LFO changes from sample to sample
+			auto sharedLevel = parentLayer.maxLevel.getCurrentValue();
+			auto fadeGain = fade.getCurrentGain();
+			for (int i = startSample; i < endSample; i++)
+			{
+				currentLevel = processLfo() * sharedLevel;
+				fadeGains[i] = currentLevel * fadeGain;
+				voiceOut[i] = osc.process() * fadeGains[i];
+			}
+		}
+		else
+		{
+			for (int i = startSample; i < endSample; i++)
+			{
+				currentLevel = processLfo() * sharedLevels[i];
+				fadeGains[i] *= currentLevel;
+				voiceOut[i] = osc.process() * fadeGains[i];
+			}
+		}
+
+		samplesUntilTrough -= endSample - startSample;
+		startSample = endSample;
+
+		if (waitingToRestart && fade.isSilent())
+		{
+			waitingToRestart = false;
+			start();
+		}
 	}
 
-	// process next sampleOut
-	currentLevel = processLevel();
+	mixSegment(output, segmentStart, numSamples - segmentStart);
 
-	// reset sample out
-	out.first = 0.0f;
-	out.second = 0.0f;
+	// the fade buffer now holds the level of every sample of the block, so it is measured in one pass each for the peak and RMS
+	peakLevel = juce::jmax(peakLevel, juce::FloatVectorOperations::findMaximum(fadeGains, numSamples));
+	sumOfSquares += jr::OutputMeter::sumOfSquares(fadeGains, numSamples);
+	numMeasuredSamples += numSamples;
+	return true;
+}
 
-	// raw value before panning
-	float oscRawOut = osc.process() * currentLevel * masterGain.getNextValue();
+void FaderPairs::RandomOsc::takeMeasuredLevels(jr::VoiceTelemetry& voice)
+{
+	if (numMeasuredSamples == 0)
+	{
+		voice.level = voice.peak = getNormalisedOscLevel();
+		return;
+	}
 
-	// add panned signals to out pair
-	out.first = oscRawOut * (1.0f - pan);
-	out.second = oscRawOut * pan;
+	auto normalRatio = parent.layers[(size_t)layer].normalRatio;
+	voice.peak = peakLevel * normalRatio;
+	voice.level = std::sqrt(sumOfSquares / (float)numMeasuredSamples) * normalRatio;
 
-	return out;
+	peakLevel = 0.0f;
+	sumOfSquares = 0.0f;
+	numMeasuredSamples = 0;
+}
+
+void FaderPairs::RandomOsc::mixSegment(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+	if (numSamples <= 0)
+	{
+		return;
+	}
+
+	const float* voiceOut = parent.voiceBuffer.getReadPointer(0, startSample);
+
+	if (parent.renderingMono)
+	{
+		juce::FloatVectorOperations::add(output.getWritePointer(0, startSample), voiceOut, numSamples);
+		return;
+	}
+
+	for (int channel{}; channel < output.getNumChannels(); channel++)
+	{
+		// ring panning only feeds two speakers, so most channels can be skipped
+		if (gains[channel] != 0.0f)
+		{
+			juce::FloatVectorOperations::addWithMultiply(output.getWritePointer(channel, startSample), voiceOut, gains[channel], numSamples);
+		}
+	}
 }
 
 void FaderPairs::RandomOsc::silence()
 {
 	if (!silenced)
 	{
-		masterGain.setTargetValue(0);
+		fade.fadeOut(parent.fadeCurve);
 		silenced = true;
 	}
 	waitingToRestart = false;
@@ -76,16 +186,16 @@ void FaderPairs::RandomOsc::silence()
 
 void FaderPairs::RandomOsc::start()
 {
-	if (masterGain.getCurrentValue() != 0.0f && silenced)
+	if (!fade.isSilent() && silenced)
 	{
 		// if the voice is silenced but has not yet been faded completely, wait
 		waitingToRestart = true;
 	}
-	else if (masterGain.getCurrentValue() == 0.0f)
+	else if (fade.isSilent())
 	{
 		// if voice is already silenced reset it and start
 		resetFrequencies();
-		masterGain.setTargetValue(1.0f);
+		fade.fadeIn(parent.fadeCurve);
 		silenced = false;
 	}
 	// if voice is not currently silenced do nothing
@@ -93,7 +203,108 @@ void FaderPairs::RandomOsc::start()
 
 void FaderPairs::RandomOsc::updateLfoFreq()
 {
-	lfo.setFrequency(getLfoFreqFromScale(lfoBaseFreq));
+	// the version is read first so that a rate change part way through is picked up next block
+	lfoRateVersion = parent.layers[(size_t)layer].lfoRateVersion.load();
+	lfo.setFrequency(parent.getLfoFreqFromScale(layer, lfoBaseFreq));
+	updateSamplesUntilTrough();
+}
+
+void FaderPairs::RandomOsc::scatterLfoPhase()
+{
+	lfo.setPhase(parent.random.nextFloat());
+	updateSamplesUntilTrough();
+}
+
+void FaderPairs::RandomOsc::processTrough(juce::AudioBuffer<float>& output, int& segmentStart, int startSample)
+{
+	// the count is worked out from the LFO's frequency, and over a slow cycle the phase it accumulates can drift a little from
+	// that, so check the trough has really been reached. A trough that has just been passed is taken late rather than missed.
+	auto distance = getPhaseToTrough(lfo.getPhase());
+	if (distance > lfo.getPhaseDelta() && distance <= 0.5f)
+	{
+		updateSamplesUntilTrough();
+		return;
+	}
+
+	// everything rendered so far this block uses the old pan position
+	mixSegment(output, segmentStart, startSample - segmentStart);
+	segmentStart = startSample;
+
+	resetOsc();
+	resetPan();
+	resetShape();
+
+	// the next sample passes the trough, so the count to the one after starts from there
+	samplesUntilTrough = getSamplesToTrough(lfo.getPhase() + lfo.getPhaseDelta());
+}
+
+void FaderPairs::RandomOsc::glideBy(float ratio)
+{
+	osc.setFrequencyOverTime(osc.getTargetFrequency() * ratio);
+}
+
+void FaderPairs::RandomOsc::updateSamplesUntilTrough()
+{
+	samplesUntilTrough = getSamplesToTrough(lfo.getPhase()) - 1;
+}
+
+int FaderPairs::RandomOsc::getSamplesToTrough(float fromPhase)
+{
+	auto phaseDelta = lfo.getPhaseDelta();
+	if (phaseDelta <= 0.0f)
+	{
+		return std::numeric_limits<int>::max();
+	}
+
+	// kept well inside the range of an int, for LFOs so slow they barely move
+	auto samples = (int)juce::jmin(std::ceil(getPhaseToTrough(fromPhase) / phaseDelta), 1.0e9f);
+
+	// each step of the phase can be rounded by up to half the precision of a float, which adds up over a slow cycle, so stop
+	// short by as much as the rounding could have added and aim at the trough again from there
+	auto margin = (int)((float)(samples - 1) * juce::jmin(0.5f, lfoPhaseRounding / phaseDelta));
+	return samples - margin;
+}
+
+float FaderPairs::RandomOsc::getPhaseToTrough(float fromPhase)
+{
+	auto distance = lfoTroughPhase - (fromPhase - std::floor(fromPhase));
+	return distance <= 0.0f ? distance + 1.0f : distance;
+}
+
+void FaderPairs::RandomOsc::captureState(VoiceState& state)
+{
+	state.oscFrequency = osc.getCurrentFrequency();
+	state.oscPhase = osc.getPhase();
+	state.waveShape = osc.getWaveShape();
+	state.lfoBaseFreq = lfoBaseFreq;
+	state.lfoPhase = lfo.getPhase();
+	state.pan = pan;
+	state.silenced = silenced;
+}
+
+void FaderPairs::RandomOsc::restoreState(const VoiceState& state)
+{
+	osc.setFrequency(state.oscFrequency);
+	osc.setPhase(state.oscPhase);
+	osc.setWaveShapeImmediately(state.waveShape);
+
+	lfoBaseFreq = state.lfoBaseFreq;
+	updateLfoFreq();
+	lfo.setPhase(state.lfoPhase);
+	updateSamplesUntilTrough();
+
+	bool wasCentred = pan == 0.5f;
+	pan = state.pan;
+	bool isCentred = pan == 0.5f;
+	if (wasCentred != isCentred)
+	{
+		parent.layers[(size_t)layer].numPannedOscs += isCentred ? -1 : 1;
+	}
+	updateGains();
+
+	silenced = state.silenced;
+	waitingToRestart = false;
+	fade.setImmediately(!silenced);
 }
 
 bool FaderPairs::RandomOsc::getIsInitialised()
@@ -106,59 +317,82 @@ void FaderPairs::RandomOsc::initOsc(float _sampleRate)
 	if (!isInitialised)
 	{
 		osc = jr::MultiWaveOsc();
-		
+
+		glideTime = parent.glideTime.load();
+		osc.setGlideTime(glideTime);
 		osc.setSampleRate(_sampleRate);
-		osc.setFrequency(parent.getRandomOscFrequency());
+		osc.setSineTable(parent.resources);
+		osc.setFrequency(parent.getRandomOscFrequency(layer));
 	}
 }
 
 void FaderPairs::RandomOsc::resetFrequencies()
 {
-	osc.setFrequency(parent.getRandomOscFrequency());
+	osc.setFrequency(parent.getRandomOscFrequency(layer));
 	lfoBaseFreq = parent.random.nextFloat();
-	lfo.setFrequency(getLfoFreqFromScale(lfoBaseFreq));
+	lfo.setFrequency(parent.getLfoFreqFromScale(layer, lfoBaseFreq));
+	updateSamplesUntilTrough();
 }
 
 void FaderPairs::RandomOsc::resetOsc()
 {
-	osc.setFrequency(parent.getRandomOscFrequency());
+	osc.setFrequency(parent.getRandomOscFrequency(layer));
 }
 
 void FaderPairs::RandomOsc::resetPan()
 {
-	pan = 0.5f + (parent.random.nextFloat() - 0.5f) * parent.stereoWidth; // set to 0.5f +/- 0.5f at max or 0.0f at min
+	auto& parentLayer = parent.layers[(size_t)layer];
+	bool wasCentred = pan == 0.5f;
+
+	pan = 0.5f + (parent.random.nextFloat() - 0.5f) * parentLayer.stereoWidth; // set to 0.5f +/- 0.5f at max or 0.0f at min
+
+	// keep count of off-centre voices so the parent knows when a mono render is equivalent
+	bool isCentred = pan == 0.5f;
+	if (wasCentred != isCentred)
+	{
+		parentLayer.numPannedOscs += isCentred ? -1 : 1;
+	}
+
+	updateGains();
 }
 
-void FaderPairs::RandomOsc::resetShape()
+void FaderPairs::RandomOsc::updateGains()
 {
-	osc.setWaveShape(parent.waveShape);
+	parent.panner.getGains(pan, gains);
 }
 
-float FaderPairs::RandomOsc::getLfoFreqFromScale(float scale)
+void FaderPairs::RandomOsc::resetShape()
 {
-	scale = jr::Utils::constrainFloat(scale);
-	return parent.minLfoFreq + ((parent.maxLfoFreq * parent.lfoRate) - parent.minLfoFreq) * scale;
+	osc.setWaveShape(parent.layers[(size_t)layer].waveShape);
 }
 
-float FaderPairs::RandomOsc::processLevel()
+float FaderPairs::RandomOsc::processLfo()
 {
 	float lfoVal = lfo.process();
 	lfoVal += 1.0f; // between 0-2
 	lfoVal /= 2.0f; // between 0-1
-	if (lfoVal <= 0.001f)
-	{
-		resetOsc();
-		resetPan();
-		resetShape();
-	}
-	return lfoVal * parent.maxLevel.getCurrentValue();
+	return lfoVal;
 }
 
 //=========================================//
 //************ FaderPairs *****************//
 //=========================================//
 
-void FaderPairs::init(size_t numOscs, float _sampleRate, size_t maxNumOscs)
+FaderPairs::FaderPairs() : spectral(std::make_unique<SpectralEngine>(*this))
+{
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		setLfoRate(layer, 0.0f);
+	}
+
+	// nothing can be picking yet, so the first table can be built in place
+	publishPitchInputs();
+	fillPitchTable(latestPitchTable);
+}
+
+FaderPairs::~FaderPairs() = default;
+
+void FaderPairs::init(size_t numOscs, float _sampleRate, size_t maxNumOscs, int samplesPerBlock)
 {
 	if (_sampleRate <= 0.0f)
 	{
@@ -167,24 +401,45 @@ void FaderPairs::init(size_t numOscs, float _sampleRate, size_t maxNumOscs)
 
 	sampleRate = _sampleRate;
 
-	gain.reset(sampleRate, 0.1f);
-	maxLevel.reset(_sampleRate, rampTime);
+	maxBlockSize = juce::jmax(1, samplesPerBlock);
+	voiceBuffer.setSize(1, maxBlockSize);
+	levelBuffer.setSize(1, maxBlockSize);
+	fadeBuffer.setSize(1, maxBlockSize);
+	monoBuffer.setSize(1, maxBlockSize);
+	layerBuffer.setSize(panner.getNumChannels(), maxBlockSize);
+	spectralBuffer.setSize(panner.getNumChannels(), maxBlockSize);
+
+	for (auto& layer : layers)
+	{
+		layer.gain.reset(sampleRate, 0.1f);
+		layer.maxLevel.reset(_sampleRate, rampTime);
+	}
+	engineMix.reset(sampleRate, rampTime);
+	engineMix.setCurrentAndTargetValue(engineMix.getTargetValue());
+
+	loudness.prepare(panner, (int)maxNumOscs);
+	adoptPitchTable();
 
 	if (_oscs.size() == 0)
 	{
 		// first time only
 
-		setMaxLevel(0.5f / (float)numOscs);
+		maxOscsPerLayer = (int)maxNumOscs;
+		layers[0].numActiveOscs = (int)numOscs;
+		_oscs.reserve(maxNumOscs * maxNumLayers);
 
-		for (int i{}; i < maxNumOscs; i++)
+		for (int layer{}; layer < maxNumLayers; layer++)
 		{
-			_oscs.push_back(RandomOsc(*this));
-			_oscs.at(i).init(sampleRate, i >= numOscs);
-		}
+			auto& parentLayer = layers[(size_t)layer];
+			parentLayer.numActiveOscs = juce::jlimit(0, maxOscsPerLayer, parentLayer.numActiveOscs);
+			setMaxLevel(layer, 1.0f / (float)juce::jmax(1, parentLayer.numActiveOscs));
 
-		numActiveOscs = numOscs;
-
-		setGainOffset();
+			for (int i{}; i < maxOscsPerLayer; i++)
+			{
+				_oscs.push_back(RandomOsc(*this, layer));
+				_oscs.back().init(sampleRate, i >= parentLayer.numActiveOscs);
+			}
+		}
 	}
 	else
 	{
@@ -195,70 +450,171 @@ void FaderPairs::init(size_t numOscs, float _sampleRate, size_t maxNumOscs)
 			pair.updateSampleRate(sampleRate);
 		}
 	}
+
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		updateGain(layer);
+	}
 }
 
-std::pair<float, float> FaderPairs::process()
+void FaderPairs::initSpectral(int numPartials, int maxNumPartials)
 {
-	out.first = 0.0f;
-	out.second = 0.0f;
+	spectral->setNumPartials(numPartials);
+	spectral->init(sampleRate, maxNumPartials, panner.getNumChannels());
+}
 
-	if (!isInitialised)
+void FaderPairs::process(juce::AudioBuffer<float>& buffer)
+{
+	buffer.clear();
+
+	if (!checkIsInitialised())
 	{
-		bool allFinished = true;
-		for (auto pair : _oscs)
+		return;
+	}
+
+	int numChannels = juce::jmin(buffer.getNumChannels(), panner.getNumChannels());
+	int numSamples = buffer.getNumSamples();
+
+	// render in chunks that fit the scratch buffers, in case the host sends a larger block than it promised
+	for (int startSample{}; startSample < numSamples; startSample += maxBlockSize)
+	{
+		juce::AudioBuffer<float> chunk{ buffer.getArrayOfWritePointers(), numChannels, startSample, juce::jmin(maxBlockSize, numSamples - startSample) };
+		processChunk(chunk);
+	}
+}
+
+void FaderPairs::processChunk(juce::AudioBuffer<float>& output)
+{
+	int numSamples = output.getNumSamples();
+
+	if (pitchInputsPending.load())
+	{
+		publishPitchInputs();
+	}
+	adoptPitchTable();
+
+	auto spectralStart = engineMix.getCurrentValue();
+	auto spectralEnd = engineMix.skip(numSamples);
+
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		auto& parentLayer = layers[(size_t)layer];
+
+		// the spectral engine stands in for the first layer, and a layer that has gone silent has nothing to render, so the
+		// oscs are only rendered while they can be heard
+		bool isReplaced = layer == 0 && spectralStart >= 1.0f && spectralEnd >= 1.0f;
+		if (isReplaced || (parentLayer.numActiveOscs == 0 && !parentLayer.isSounding))
 		{
-			if (!pair.getIsInitialised())
-			{
-				allFinished = false;
-				break;
-			}
+			parentLayer.maxLevel.skip(numSamples);
+			parentLayer.gain.skip(numSamples);
+			continue;
 		}
-		isInitialised = allFinished;
-		if (!isInitialised)
+
+		if (layer == 0)
+		{
+			processLayer(layer, output, 1.0f - spectralStart, 1.0f - spectralEnd);
+		}
+		else
 		{
-			return out;
+			processLayer(layer, output, 1.0f, 1.0f);
 		}
 	}
 
-	float sampleOut{};
+	if (spectralStart > 0.0f || spectralEnd > 0.0f)
+	{
+		juce::AudioBuffer<float> spectralOut{ spectralBuffer.getArrayOfWritePointers(), output.getNumChannels(), numSamples };
+		spectral->process(spectralOut);
 
-	processSharedLevels();
+		for (int channel{}; channel < output.getNumChannels(); channel++)
+		{
+			output.addFromWithRamp(channel, 0, spectralOut.getReadPointer(channel), numSamples, spectralStart, spectralEnd);
+		}
+	}
+}
 
-	for (auto& pair : _oscs)
+void FaderPairs::processLayer(int layer, juce::AudioBuffer<float>& output, float startGain, float endGain)
+{
+	int numSamples = output.getNumSamples();
+	auto& parentLayer = layers[(size_t)layer];
+
+	processSharedLevels(layer, numSamples);
+
+	// if every voice of the layer shares the same position they can be summed in mono and spread to the outputs once at the end
+	renderingMono = isCentred(layer) || output.getNumChannels() == 1;
+
+	juce::AudioBuffer<float> mono{ monoBuffer.getArrayOfWritePointers(), 1, numSamples };
+	juce::AudioBuffer<float> mix{ layerBuffer.getArrayOfWritePointers(), output.getNumChannels(), numSamples };
+	auto& target = renderingMono ? mono : mix;
+	target.clear();
+
+	bool isSounding = false;
+	auto first = _oscs.begin() + layer * maxOscsPerLayer;
+	for (auto pair = first; pair != first + maxOscsPerLayer; pair++)
 	{
-		auto pairOut = pair.process();
-		out.first += pairOut.first;
-		out.second += pairOut.second;
+		isSounding = pair->process(target) || isSounding;
 	}
+	parentLayer.isSounding = isSounding;
 
-	gain.getNextValue();
+	// the layer's gain is applied as it is added to the output, along with the spread of a mono render
+	startGain *= parentLayer.gain.getCurrentValue();
+	endGain *= parentLayer.gain.skip(numSamples);
+	if (!isSounding)
+	{
+		return;
+	}
 
-	out.first *= gain.getCurrentValue();
-	out.second *= gain.getCurrentValue();
+	for (int channel{}; channel < output.getNumChannels(); channel++)
+	{
+		auto spread = renderingMono ? centreGains[channel] : 1.0f;
+		output.addFromWithRamp(channel, 0, target.getReadPointer(renderingMono ? 0 : channel), numSamples, startGain * spread, endGain * spread);
+	}
+}
 
-	return out;
+bool FaderPairs::checkIsInitialised()
+{
+	if (!isInitialised)
+	{
+		bool allFinished = true;
+		for (auto& pair : _oscs)
+		{
+			if (!pair.getIsInitialised())
+			{
+				allFinished = false;
+				break;
+			}
+		}
+		isInitialised = allFinished;
+	}
+	return isInitialised;
 }
 
-void FaderPairs::setWaveShape(float _waveShape)
+void FaderPairs::setWaveShape(int layer, float _waveShape)
 {
-	waveShape = jr::Utils::constrainFloat(_waveShape);
+	layers[(size_t)layer].waveShape = jr::Utils::constrainFloat(_waveShape);
+	updateGain(layer);
 }
 
-void FaderPairs::setMaxLevel(float _maxLevel)
+void FaderPairs::setMaxLevel(int layer, float _maxLevel)
 {
-	maxLevel.setTargetValue(_maxLevel);
+	layers[(size_t)layer].maxLevel.setTargetValue(_maxLevel);
 }
 
-void FaderPairs::processSharedLevels()
+void FaderPairs::processSharedLevels(int layer, int numSamples)
 {
-	maxLevel.getNextValue();
-	normalRatio = 1.0f / maxLevel.getCurrentValue();
+	auto& parentLayer = layers[(size_t)layer];
+	parentLayer.levelIsConstant = parentLayer.maxLevel.fillBlock(levelBuffer.getWritePointer(0), numSamples);
+	parentLayer.normalRatio = 1.0f / parentLayer.maxLevel.getCurrentValue();
 }
 
-void FaderPairs::setNumOscs(int numOscs)
+void FaderPairs::setNumOscs(int layer, int numOscs)
 {
+	auto& parentLayer = layers[(size_t)layer];
+	int numActiveOscs = parentLayer.numActiveOscs;
+
 	if (_oscs.size() == 0)
 	{
+		// kept for init() to start the layer with
+		parentLayer.numActiveOscs = juce::jmax(0, numOscs);
 		return;
 	}
 
@@ -270,51 +626,288 @@ void FaderPairs::setNumOscs(int numOscs)
 	{
 		numOscs = 0;
 	}
-	else if (numOscs > _oscs.size())
+	else if (numOscs > maxOscsPerLayer)
 	{
-		numOscs = _oscs.size();
+		numOscs = maxOscsPerLayer;
 	}
 	
-	setMaxLevel(1.0f / (float)numOscs);
+	setMaxLevel(layer, 1.0f / (float)juce::jmax(1, numOscs));
 
+	// the layer's voices follow on from those of the layers before it
+	int first = layer * maxOscsPerLayer;
 	if (numOscs < numActiveOscs) // silencing n oscs
 	{
 		for (int i{ numActiveOscs - 1 }; i >= numOscs; i--)
 		{
-			_oscs.at(i).silence();
+			_oscs.at(first + i).silence();
 		}
 	}
 	else if (numOscs > numActiveOscs) // starting n oscs
 	{
 		for (int i{ numActiveOscs }; i < numOscs; i++)
 		{
-			_oscs.at(i).start();
+			_oscs.at(first + i).start();
 		}
 	}
 
-	numActiveOscs = numOscs;
-	setGainOffset();
+	parentLayer.numActiveOscs = numOscs;
+	updateGain(layer);
+}
+
+void FaderPairs::setNumPartials(int numPartials)
+{
+	spectral->setNumPartials(numPartials);
+}
+
+void FaderPairs::setEngine(Engine engine)
+{
+	engineMix.setTargetValue(engine == Engine::spectral ? 1.0f : 0.0f);
+}
+
+void FaderPairs::setLfoRate(int layer, float _rate)
+{
+	auto& parentLayer = layers[(size_t)layer];
+	parentLayer.lfoRate = jr::Utils::constrainFloat(_rate);
+	parentLayer.lfoFreqSpan = maxLfoFreq * parentLayer.lfoRate - minLfoFreq;
+	parentLayer.lfoRateVersion++;
+}
+
+void FaderPairs::writeTelemetry(jr::TelemetryFrame& frame)
+{
+	frame.numVoices = juce::jmin((int)_oscs.size(), jr::TelemetryFrame::maxVoices);
+	frame.numActiveVoices = 0;
+	for (auto& layer : layers)
+	{
+		frame.numActiveVoices += layer.numActiveOscs;
+	}
+
+	for (int i{}; i < frame.numVoices; i++)
+	{
+		auto& osc = _oscs[i];
+		auto& voice = frame.voices[i];
+		voice.frequency = osc.getOscFrequency();
+		osc.takeMeasuredLevels(voice);
+		voice.pan = osc.getPan();
+		voice.waveShape = osc.getWaveShape();
+		voice.active = !osc.getIsSilenced();
+	}
+}
+
+void FaderPairs::applySettings(const Settings& settings)
+{
+	// every pitch input is set before any is published, so the tables are never built from part of the new settings
+	pitchMode = settings.pitchMode;
+	rootNote = settings.rootNote;
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		layers[(size_t)layer].minOscFreq = settings.layers[(size_t)layer].minFreq;
+		layers[(size_t)layer].maxOscFreq = settings.layers[(size_t)layer].maxFreq;
+	}
+
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		applyLayerSettings(layer, settings.layers[(size_t)layer]);
+	}
+
+	setNumPartials(settings.numPartials);
+	setEngine(settings.engine);
+}
+
+void FaderPairs::applyLayerSettings(int layer, const LayerSettings& settings)
+{
+	// every shared value is set before any voice is touched, so each voice is only visited once. Voices that start pick from
+	// the new range straight away in the continuous pitch modes, and once the tables are rebuilt in the others. The LFOs pick
+	// up the new rate when they are next processed.
+	auto& parentLayer = layers[(size_t)layer];
+	parentLayer.minOscFreq = settings.minFreq;
+	parentLayer.maxOscFreq = settings.maxFreq;
+	publishPitchInputs();
+	setLfoRate(layer, settings.lfoRate);
+	parentLayer.stereoWidth = jr::Utils::constrainFloat(settings.stereoWidth);
+	parentLayer.waveShape = jr::Utils::constrainFloat(settings.waveShape);
+
+	// voices fade in and out as usual
+	setNumOscs(layer, settings.numOscs);
+	updateGain(layer);
 }
 
-void FaderPairs::setLfoRate(float _rate)
+void FaderPairs::scatterLfoPhases()
 {
-	lfoRate = jr::Utils::constrainFloat(_rate);
 	for (auto& pair : _oscs)
 	{
-		pair.updateLfoFreq();
+		pair.scatterLfoPhase();
 	}
+	spectral->scatterLfoPhases();
 }
 
-void FaderPairs::setStereoWidth(float width)
+void FaderPairs::captureSnapshot(Snapshot& snapshot)
 {
-	stereoWidth = jr::Utils::constrainFloat(width);
+	snapshot.voices.resize(_oscs.size());
+	for (size_t i{}; i < _oscs.size(); i++)
+	{
+		_oscs[i].captureState(snapshot.voices[i]);
+	}
+
+	snapshot.numActiveOscs = layers[0].numActiveOscs;
+	snapshot.randomSeed = random.getSeed();
+}
+
+void FaderPairs::restoreSnapshot(const Snapshot& snapshot)
+{
+	auto numVoices = juce::jmin(snapshot.voices.size(), _oscs.size());
+	for (size_t i{}; i < numVoices; i++)
+	{
+		_oscs[i].restoreState(snapshot.voices[i]);
+	}
+
+	random.setSeed(snapshot.randomSeed);
+
+	// layers that an older snapshot has no voices for carry on as they were
+	for (int layer{}; layer < maxNumLayers && layer * maxOscsPerLayer < (int)numVoices; layer++)
+	{
+		auto& parentLayer = layers[(size_t)layer];
+		if (layer == 0)
+		{
+			parentLayer.numActiveOscs = juce::jlimit(0, maxOscsPerLayer, snapshot.numActiveOscs);
+		}
+		else
+		{
+			// voices are started in order, so the count is the number of the layer's voices that were playing
+			auto first = _oscs.begin() + layer * maxOscsPerLayer;
+			parentLayer.numActiveOscs = (int)std::count_if(first, first + maxOscsPerLayer, [](RandomOsc& pair) { return !pair.getIsSilenced(); });
+		}
+
+		// jump straight to the levels for the restored voice count rather than fading to them
+		parentLayer.maxLevel.setCurrentAndTargetValue(1.0f / (float)juce::jmax(1, parentLayer.numActiveOscs));
+		updateGain(layer);
+		parentLayer.gain.setCurrentAndTargetValue(parentLayer.gain.getTargetValue());
+		parentLayer.isSounding = true;
+	}
+}
+
+void FaderPairs::setStereoWidth(int layer, float width)
+{
+	layers[(size_t)layer].stereoWidth = jr::Utils::constrainFloat(width);
+	updateGain(layer);
+}
+
+void FaderPairs::setOutputLayout(const juce::AudioChannelSet& layout)
+{
+	panner.setLayout(layout);
+	panner.getGains(0.5f, centreGains);
+
+	for (auto& pair : _oscs)
+	{
+		pair.updateGains();
+	}
+	spectral->updateGains();
+}
+
+float FaderPairs::getLfoFreqFromScale(int layer, float scale)
+{
+	scale = jr::Utils::constrainFloat(scale);
+	return minLfoFreq + layers[(size_t)layer].lfoFreqSpan * scale;
+}
+
+void FaderPairs::setScale(const jr::PitchTable::Scale& _scale)
+{
+	const juce::SpinLock::ScopedLockType lock(scaleLock);
+	scale = _scale;
+	pitchVersion++;
+}
+
+void FaderPairs::setTransposition(float semitones)
+{
+	auto ratio = std::pow(2.0f, (semitones - transposition.load()) / 12.0f);
+	transposition = semitones;
+	publishPitchInputs();
+
+	// voices that start before the tables are rebuilt still get the new pitch
+	updatePitchTableRatio();
+
+	for (auto& pair : _oscs)
+	{
+		pair.glideBy(ratio);
+	}
+	spectral->transpose(ratio);
+}
+
+float FaderPairs::getRandomOscFrequency(int layer)
+{
+	// the continuous modes have nothing to build, so they follow the live range rather than waiting for a table
+	auto mode = pitchMode.load();
+	if (jr::PitchTable::isContinuous(mode))
+	{
+		auto& parentLayer = layers[(size_t)layer];
+		auto ratio = std::pow(2.0f, transposition.load() / 12.0f);
+		return jr::PitchTable::getRandomContinuousFrequency(mode, parentLayer.minOscFreq.load() * ratio, parentLayer.maxOscFreq.load() * ratio, random);
+	}
+
+	return pitchTables[(size_t)activePitchTable.load()][(size_t)layer].getRandomFrequency(random) * pitchTableRatio;
 }
 
-void FaderPairs::setGainOffset()
+bool FaderPairs::buildPitchTable()
 {
-	auto g1 = 0.3f + 0.2f * jr::Utils::constrainFloat((numActiveOscs - 1) / 14.0f); // ramp volume from 0.3 to 0.5 between 1 osc and 14
+	// the table that was picked from before the last swap may still be in use until the swap has been picked up
+	int latest = latestPitchTable.load();
+	if (activePitchTable.load() != latest)
+	{
+		return false;
+	}
 
-	gainOffset = jr::Utils::constrainFloat((numActiveOscs - 20) / 80.0f); // used to ramp volume from 0.5 to 1.0 between 20 and 80 oscs
+	int spare = 1 - latest;
+	fillPitchTable(spare);
+	latestPitchTable = spare;
+	return true;
+}
 
-	gain.setTargetValue(g1 + 0.5f * gainOffset);
+void FaderPairs::publishPitchInputs()
+{
+	const juce::SpinLock::ScopedTryLockType lock(scaleLock);
+	if (!lock.isLocked())
+	{
+		pitchInputsPending = true;
+		return;
+	}
+
+	auto& inputs = publishedPitchInputs;
+	inputs.mode = pitchMode.load();
+	inputs.rootNote = rootNote.load();
+	inputs.transposition = transposition.load();
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		inputs.ranges[(size_t)layer] = { layers[(size_t)layer].minOscFreq.load(), layers[(size_t)layer].maxOscFreq.load() };
+	}
+
+	pitchInputsPending = false;
+	pitchVersion++;
+}
+
+void FaderPairs::fillPitchTable(int index)
+{
+	// the inputs and version are only changed under the lock, so the table always matches the version it is marked with
+	const juce::SpinLock::ScopedLockType lock(scaleLock);
+	pitchTableVersion = pitchVersion.load();
+
+	const auto& inputs = publishedPitchInputs;
+	pitchTableTranspositions[(size_t)index] = inputs.transposition;
+	auto ratio = std::pow(2.0f, inputs.transposition / 12.0f);
+	auto rootFreq = 440.0f * std::pow(2.0f, (inputs.rootNote + inputs.transposition - 69.0f) / 12.0f);
+	for (int layer{}; layer < maxNumLayers; layer++)
+	{
+		auto [minFreq, maxFreq] = inputs.ranges[(size_t)layer];
+		pitchTables[(size_t)index][(size_t)layer].build(inputs.mode, minFreq * ratio, maxFreq * ratio, rootFreq, scale);
+	}
+}
+
+void FaderPairs::updateGain(int layer)
+{
+	auto& parentLayer = layers[(size_t)layer];
+	parentLayer.gain.setTargetValue(loudness.getGain(parentLayer.numActiveOscs, parentLayer.waveShape, parentLayer.stereoWidth));
+
+	// the spectral engine follows the first layer
+	if (layer == 0)
+	{
+		spectral->updateLevel();
+	}
 }
\ No newline at end of file
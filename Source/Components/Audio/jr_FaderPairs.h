@@ -2,54 +2,251 @@
 
 #include <JuceHeader.h>
 #include <vector>
+#include <atomic>
+#include <limits>
+#include <array>
+#include <cmath>
+#include <utility>
 #include "jr_Oscillators.h"
 #include "jr_MultiWaveOsc.h"
+#include "jr_Smoother.h"
+#include "jr_VoiceFade.h"
+#include "jr_PitchTable.h"
+#include "jr_Panner.h"
+#include "jr_LoudnessModel.h"
+#include "jr_Telemetry.h"
+#include "../../Utils/jr_SharedResources.h"
 #include "../../Utils/jr_Utils.h"
 
 class FaderPairs
 {
 public:
-	FaderPairs() {}
+	/*
+	The engines that the oscs can be rendered with. Oscillators runs every voice as a RandomOsc, Spectral draws many more
+	partials following the same random model with an inverse FFT.
+	*/
+	enum class Engine { oscillators, spectral };
+
+	/*
+	The number of layers of voices, each with its own voice count, rate, frequency range, stereo width and wave shape, so that
+	for example a low bed and a high shimmer can play together. Every layer's voices come from the same pool and are rendered
+	by the same code into the same scratch buffers, so a layer costs little more than its voices.
+	*/
+	static constexpr int maxNumLayers = 4;
+
+	/*
+	The settings that each layer has its own copy of
+	*/
+	struct LayerSettings
+	{
+		int numOscs{ 0 };
+		float lfoRate{ 0.0f };
+		float minFreq{ 120.0f };
+		float maxFreq{ 1200.0f };
+		float stereoWidth{ 0.0f };
+		float waveShape{ 0.0f };
+	};
+
+	/*
+	A snapshot of every setting that shapes the sound of the drone, so that another FaderPairs can be set up to sound the same
+	*/
+	struct Settings
+	{
+		std::array<LayerSettings, maxNumLayers> layers{ LayerSettings{ 3 } };	// only the first layer plays by default
+		int numPartials{ 1000 };
+		Engine engine{ Engine::oscillators };
+		jr::PitchTable::Mode pitchMode{ jr::PitchTable::Mode::linear };
+		float rootNote{ 36.0f };
+	};
+
+	/*
+	Everything needed to put a voice back exactly where it was
+	*/
+	struct VoiceState
+	{
+		float oscFrequency{};
+		float oscPhase{};
+		float waveShape{};
+		float lfoBaseFreq{};
+		float lfoPhase{};
+		float pan{ 0.5f };
+		bool silenced{ false };
+	};
+
+	/*
+	The state of every voice and of the random number generator, so that the drone can be restored to sound exactly as it did
+	and carry on the same way. The spectral engine is not included, and restarts with new partials.
+	*/
+	struct Snapshot
+	{
+		std::vector<VoiceState> voices;							// every voice of the first layer, followed by those of each other layer
+		int numActiveOscs{ 0 };									// of the first layer, the other layers' are counted from their voices
+		juce::int64 randomSeed{ 0 };
+	};
+
+	FaderPairs();
+	~FaderPairs();
+
+	/*
+	initialises the pairs, creating maxNumPairs for each layer. numPairs is the number of voices the first layer starts with,
+	and the other layers start with the counts they were given before init(). samplesPerBlock sets the size of the scratch
+	buffers used while rendering.
+	*/
+	void init(size_t numPairs, float _sampleRate, size_t maxNumPairs, int samplesPerBlock);
+
+	/*
+	Sets up the spectral engine with the number of partials it should play and the maximum it can play.
+	Call after init().
+	*/
+	void initSpectral(int numPartials, int maxNumPartials);
+
+	/*
+	Processes all of the pairs, replacing the contents of buffer with the combined output of all oscs panned across its channels.
+	*/
+	void process(juce::AudioBuffer<float>& buffer);
+
+	/*
+	Sets the speaker layout that the oscs are panned across, and recalculates the channel gains of every osc.
+	Call before playing, not while processing.
+	*/
+	void setOutputLayout(const juce::AudioChannelSet& layout);
+
+	/*
+	Returns true if every voice of the layer is panned to the centre, in which case they can be mixed in mono and spread to the
+	outputs once
+	*/
+	bool isCentred(int layer) { return layers[(size_t)layer].stereoWidth == 0.0f && layers[(size_t)layer].numPannedOscs == 0; }
+
+	/*
+	Sets the number of desired active oscs of the layer and silences / starts voices as needed. Before init() the count is
+	stored for the layer to start with.
+	*/
+	void setNumOscs(int layer, int numOscs);
+
+	/*
+	Sets the number of partials the spectral engine plays
+	*/
+	void setNumPartials(int numPartials);
+
+	/*
+	Crossfades the first layer to the given engine. The spectral engine follows the first layer's settings, and the other
+	layers always play oscillators.
+	*/
+	void setEngine(Engine engine);
+
+	/*
+	Sets the layer's LFO Rate which effectively controls the range of LFO frequency values. Rate is between 0 and 1.
+	Only the shared mapping is updated here, each voice picks up the new rate at the start of its next block.
+	*/
+	void setLfoRate(int layer, float _rate);
+
+	/*
+	Sets the minimum frequency in Hz that the layer's Oscillators will use
+	*/
+	void setMinFreq(int layer, float _minFreq)
+	{
+		layers[(size_t)layer].minOscFreq = _minFreq;
+		publishPitchInputs();
+	}
+
+	/*
+	Sets the maximum frequency in Hz that the layer's Oscillators will use
+	*/
+	void setMaxFreq(int layer, float _maxFreq)
+	{
+		layers[(size_t)layer].maxOscFreq = _maxFreq;
+		publishPitchInputs();
+	}
+
+	/*
+	Sets how new frequencies are picked within the range. Voices keep their frequencies until they are next re-randomised.
+	*/
+	void setPitchMode(jr::PitchTable::Mode mode)
+	{
+		pitchMode = mode;
+		publishPitchInputs();
+	}
+
+	/*
+	Sets the root that harmonics and scales are built on, as a MIDI note number that can be fractional
+	*/
+	void setRootNote(float note)
+	{
+		rootNote = note;
+		publishPitchInputs();
+	}
+
+	/*
+	Sets the scale used by jr::PitchTable::Mode::scala. Call from the message thread.
+	*/
+	void setScale(const jr::PitchTable::Scale& _scale);
+
+	/*
+	Moves the root and the frequency range by the given number of semitones, as when a MIDI note is played. Every voice glides
+	to its new frequency over the glide time and the spectral engine's partials move straight away. Voices that start afterwards
+	get the new pitch straight away too, even before the pitch tables have been rebuilt. Call from the thread that processes.
+	*/
+	void setTransposition(float semitones);
+
+	/*
+	Sets the time voices take to glide when the root is moved. Each voice picks it up at the start of its next block.
+	*/
+	void setGlideTime(float seconds) { glideTime = juce::jmax(0.01f, seconds); }
+
+	/*
+	Returns true if a range, the pitch mode, root or scale has changed since the pitch tables were last built
+	*/
+	bool needsPitchTable() const { return pitchTableVersion.load() != pitchVersion.load(); }
 
 	/*
-	initialises the pairs, creating an array of the max possible size.
+	Builds every layer's pitch table from its range and the current pitch mode, root and scale into whichever set of tables
+	isn't being picked from, and swaps them in for the thread that processes to pick up at the start of its next block. Call
+	from any thread but that one. Returns false without building if the previous tables haven't been picked up yet, in which
+	case try again later.
 	*/
-	void init(size_t numPairs, float _sampleRate, size_t maxNumPairs);
+	bool buildPitchTable();
 
 	/*
-	Processes all of the pairs, and returns the L and R sample out values for all oscs combined.
+	* Sets the stereo width of the layer's oscillators. 0.0f = mono, 1.0f = full stereo width.
 	*/
-	std::pair<float, float> process();
+	void setStereoWidth(int layer, float width);
 
 	/*
-	Sets the number of desired active oscs and silences / starts voices as needed.
+	Sets the curve voices fade in and out along when they are started and silenced. Fades already in progress keep their curve.
 	*/
-	void setNumOscs(int numOscs);
+	void setFadeCurve(jr::VoiceFade::Curve curve) { fadeCurve = curve; }
 
 	/*
-	Sets LFO Rate which effectively controls the range of LFO frequency values. Rate is between 0 and 1
+	Sets the wave shape of the layer's oscillators 0=Sine 1=Triange, between those values mixes the two shapes proportionally
 	*/
-	void setLfoRate(float _rate);
+	void setWaveShape(int layer, float _waveShape);
 
 	/*
-	Sets the minimum frequency in Hz that the Oscillators will use
+	Applies every value in settings in one pass over the voices, with voices fading in and out as usual. Can be used before
+	init(), in which case the voices start out with these settings.
 	*/
-	void setMinFreq(float _minFreq) { minOscFreq = _minFreq; }
+	void applySettings(const Settings& settings);
 
 	/*
-	Sets the maximum frequency in Hz that the Oscillators will use
+	Applies every value in settings to the layer, in the same way as applySettings()
 	*/
-	void setMaxFreq(float _maxFreq) { maxOscFreq = _maxFreq; }
+	void applyLayerSettings(int layer, const LayerSettings& settings);
 
 	/*
-	* Sets the stereo width of the oscillators. 0.0f = mono, 1.0f = full stereo width.
+	Moves every voice's LFO to a random point in its cycle, so that the voices do not all start their first cycle together
 	*/
-	void setStereoWidth(float width);
+	void scatterLfoPhases();
 
 	/*
-	Sets the wave shape of the oscillators 0=Sine 1=Triange, between those values mixes the two shapes proportionally
+	Fills snapshot with the current state of every voice. Does not allocate if snapshot.voices already has the capacity for
+	every voice, so it can be called from the thread that processes.
 	*/
-	void setWaveShape(float _waveShape);
+	void captureSnapshot(Snapshot& snapshot);
+
+	/*
+	Puts every voice back to the state in snapshot, without fading. Call from the thread that processes, after init().
+	*/
+	void restoreSnapshot(const Snapshot& snapshot);
 
 	// =========================== Nested RandomOsc class start ===========================
 	// This class is nested so that it can access protected members of the FadersPairs class,
@@ -58,7 +255,7 @@ public:
 	class RandomOsc
 	{
 	public:
-		RandomOsc(FaderPairs& _parent) : parent(_parent) {};
+		RandomOsc(FaderPairs& _parent, int _layer) : parent(_parent), layer(_layer) {};
 
 		/*
 		Initialises oscillators and LFOs with sample rate. Call before playing.
@@ -71,10 +268,16 @@ public:
 		void updateSampleRate(float _sampleRate);
 
 		/*
-		Processes the oscillator and returns the next sample out values.
-		Call each sample.
+		Processes the oscillator for every sample in output, and adds the result to each channel scaled by that channel's gain.
+		When the parent is rendering in mono the result is added unscaled to the first channel. Returns false if the voice is
+		silent and nothing was added.
+		*/
+		bool process(juce::AudioBuffer<float>& output);
+
+		/*
+		Recalculates the gain of each output channel from the current pan value. Use after the output layout has changed.
 		*/
-		std::pair<float, float> process();
+		void updateGains();
 
 		/*
 		Stops instance.
@@ -87,25 +290,51 @@ public:
 		void start();
 
 		/*
-		Triggers instance to recalculate LFO frequency. Use after shared LFO Rate or LFO Spread values have changed.
+		Triggers instance to recalculate LFO frequency. Called at the start of a block whenever the shared LFO rate has changed.
 		*/
 		void updateLfoFreq();
 
+		/*
+		Moves the LFO to a random point in its cycle
+		*/
+		void scatterLfoPhase();
+
+		/*
+		Glides the oscillator to its frequency multiplied by ratio, from wherever it is gliding to
+		*/
+		void glideBy(float ratio);
+
+		/*
+		Fills state with the current state of the voice
+		*/
+		void captureState(VoiceState& state);
+
+		/*
+		Puts the voice back to the given state, without fading
+		*/
+		void restoreState(const VoiceState& state);
+
 		/*
 		Returns True if initialisation is finished for instance
 		*/
 		bool getIsInitialised();
 
-		bool getIsSilenced() { return silenced && masterGain.getCurrentValue() == 0.0f; }
+		bool getIsSilenced() { return silenced && fade.isSilent(); }
 
 		/*
 		Returns the current level of oscillator, normalised to be between 0 and 1
 		*/
 		float getNormalisedOscLevel()
 		{
-			return currentLevel * parent.normalRatio;
+			return currentLevel * parent.layers[(size_t)layer].normalRatio;
 		}
 
+		/*
+		Writes the peak and RMS level of the oscillator since the last call into voice, normalised to be between 0 and 1, and
+		starts measuring again. If nothing has been processed since the last call both are set to the current level.
+		*/
+		void takeMeasuredLevels(jr::VoiceTelemetry& voice);
+
 		/*
 		Returns the current frequency of the oscillator at the given index
 		*/
@@ -153,73 +382,214 @@ public:
 		void resetShape();
 
 		/*
-		Sets the LFO frequency to its new value, using the scale value (between 0 and 1) to set the freq within the lfoSpread and lfoRate
+		Processes the LFO and returns its value normalised between 0 and 1, to be used to calculate the level of output.
 		*/
-		float getLfoFreqFromScale(float scale);
+		float processLfo();
 
 		/*
-		Processes the level values of the oscillator and returns the current LFO level value to be used to calculate
-		the level of output.
-		Also checks whether oscillator is currently silenced and resets it's frequencies and panning if so.
+		Re-randomises the frequency, pan and shape once the LFO reaches its trough, where the voice is silent, and counts down
+		to the next one. The part of the block before startSample is mixed first with the old pan position.
 		*/
-		float processLevel();
+		void processTrough(juce::AudioBuffer<float>& output, int& segmentStart, int startSample);
+
+		/*
+		Works out samplesUntilTrough from the LFO's phase and frequency. Call whenever either is changed.
+		*/
+		void updateSamplesUntilTrough();
+
+		/*
+		Returns the number of samples the LFO takes to pass the bottom of its cycle from the given phase, at least 1. For slow LFOs
+		this falls short of the trough by as much as rounding the phase could account for.
+		*/
+		int getSamplesToTrough(float fromPhase);
+
+		/*
+		Returns how far the LFO has to move from the given phase to reach the bottom of its cycle, greater than 0 and at most 1
+		*/
+		float getPhaseToTrough(float fromPhase);
+
+		/*
+		Adds the section of the parent's voice buffer between startSample and startSample + numSamples to the output using the current gains.
+		*/
+		void mixSegment(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+		static constexpr float lfoTroughPhase = 0.75f;			// the sine is at its lowest three quarters of the way through its cycle
+		static constexpr float lfoPhaseRounding = std::numeric_limits<float>::epsilon() * 0.5f;	// twice the most a step of the LFO phase can be rounded by
 
 		FaderPairs& parent;										// contains shared values such as Frequency Range and Pan Range
+		int layer;												// index of the layer in parent that the voice belongs to
 		SineOsc lfo;											// LFO to control level of fader					
 		jr::MultiWaveOsc osc;										// Audible oscillator
-		juce::SmoothedValue<float> masterGain{ 0.0f };			// master gain for fading in and out
+		jr::VoiceFade fade;										// fades the voice in and out when it is started and silenced
 		bool silenced{ false };
 		bool waitingToRestart{ false };							// true if the voice is waiting to reach 0 master gain before restarting
 		float lfoBaseFreq{};									// scale value between 0-1 that will be used to set the current LFO rate based on the GUI parameter range set
-		std::pair<float, float> out{ 0.5f, 0.5f };				// signal out values left and right
+		int lfoRateVersion{ -1 };								// version of the shared LFO rate the LFO frequency was last worked out from
+		float glideTime{ 0.0f };								// the shared glide time the oscillator was last set to
 		float pan{ 0.5f };										// pan value for osc, 0=L 1=R 0.5=C
+		jr::Panner::Gains gains{};								// gain for each output channel, calculated from pan whenever it changes
+		int samplesUntilTrough{ 0 };							// samples to render before the LFO next reaches, or is next checked for, its trough
 		bool isInitialised{ false };							// false if initialisation is still in progress
 		float currentLevel{};									// saved so that level can be sent easily to the GUI
+		float peakLevel{};										// highest level since the levels were last taken
+		float sumOfSquares{};									// sum of the squared level of every sample since the levels were last taken
+		int numMeasuredSamples{ 0 };							// number of samples in sumOfSquares
 	};
 	// =========================== Nested RandomOsc class end ===========================
 
+	// Spectral engine for large voice counts, defined in jr_SpectralEngine.h
+	class SpectralEngine;
+
 	/*
-	Returns a pointer to the vector of oscillators, used so that these can be referenced in the GUI for drawing the sound visualiser 
+	Fills frame with the current state of every osc, for the GUI to draw the sound visualiser from. Call from the thread that processes.
 	*/
-	std::shared_ptr<std::vector<FaderPairs::RandomOsc>> getOscs() { return std::make_shared <std::vector<FaderPairs::RandomOsc>>(_oscs); }
+	void writeTelemetry(jr::TelemetryFrame& frame);
 
 private:
 	/*
-	Sets gain offset which is used to reduce the apparent loudness difference when increasing the number of voices.
+	Sets the target of the layer's output gain from the loudness model, so that its oscs keep the same level when the number of
+	voices, wave shape or stereo width changes.
+	*/
+	void updateGain(int layer);
+
+	/*
+	Returns true once all oscs have finished initialising
+	*/
+	bool checkIsInitialised();
+
+	/*
+	Renders the current engine(s) into output, which must be no longer than the scratch buffers
+	*/
+	void processChunk(juce::AudioBuffer<float>& output);
+
+	/*
+	Renders the layer's RandomOscs and adds them to output, with the layer's gain ramping from startGain to endGain times its
+	loudness gain over the block
 	*/
-	void setGainOffset();
+	void processLayer(int layer, juce::AudioBuffer<float>& output, float startGain, float endGain);
 
-	std::vector<RandomOsc> _oscs{};
+	std::vector<RandomOsc> _oscs{};				// maxOscsPerLayer voices for each layer in turn
+	int maxOscsPerLayer{ 0 };
 	float sampleRate{};
-	int numActiveOscs{ 0 };						// how many oscs are currently active i.e. not silenced
-	float gainOffset{};							// offset to manage gain difference between few voices and many voices
-	juce::SmoothedValue<float> gain{ 0.0f };
-	std::pair<float, float> out{};				// signal out values left and right
+	int maxBlockSize{ 0 };						// number of samples the scratch buffers can hold
+	juce::AudioBuffer<float> layerBuffer;		// accumulates a layer's oscs before its gain is applied
+	juce::AudioBuffer<float> monoBuffer;		// accumulates a layer's oscs when they can be rendered in mono
+	jr::Panner::Gains centreGains{};			// output channel gains for a centred osc, used to spread the mono render
+	std::unique_ptr<SpectralEngine> spectral;	// alternative engine for large numbers of partials
+	juce::AudioBuffer<float> spectralBuffer;	// output of the spectral engine while it is being mixed in
+	juce::SmoothedValue<float> engineMix{ 0.0f };	// crossfade of the first layer between engines, 0=Oscillators 1=Spectral
+	jr::LoudnessModel loudness;					// expected level of a layer's oscs for its settings, built in init()
 	bool isInitialised{ false };				// false if initialisation is still in progress
 
 protected:
+	/*
+	The settings of a layer and the state shared by its voices
+	*/
+	struct Layer
+	{
+		float lfoRate{ 0.0f };					// rate to modify the LFO freq by (0-1)
+		float lfoFreqSpan{ 0.0f };				// range of LFO frequencies in Hz for the current rate, set with the rate
+		std::atomic<int> lfoRateVersion{ 0 };	// increased whenever the rate changes, so voices know to update their LFOs
+		std::atomic<float> minOscFreq{ 120.0f };	// minimum osc frequency when generating random in Hz, published for the pitch tables
+		std::atomic<float> maxOscFreq{ 1200.0f };	// maximum osc frequency when picking a random frequency in Hz, published for the pitch tables
+		float stereoWidth{ 0.0f };				// pan range 0 - 1.0
+		float waveShape{ 0.0f };				// waveShape to be used by oscialltors, 0=Sine, 1=Tri
+		int numActiveOscs{ 0 };					// how many oscs are currently active i.e. not silenced
+		int numPannedOscs{ 0 };					// number of oscs that are not currently panned to centre
+		bool isSounding{ false };				// true if any osc was heard in the last block, so the layer can be skipped once it is silent
+		jr::Smoother maxLevel{};				// the maximum combined level of each osc fader - will be referenced by all oscillators
+		bool levelIsConstant{ false };			// true if every value of maxLevel in the level buffer is the same this block
+		float normalRatio{ 1.0f };				// the factor to multiply current osc level by to get level in range of 0-1
+		jr::Smoother gain{ 0.0f };				// output gain of the oscs, set by the loudness model
+	};
+
+	/*
+	* returns a new randomised Osc Freq value in Hz for the layer using its max and min values and the pitch mode.
+	*/
+	float getRandomOscFrequency(int layer);
+
+	/*
+	Everything the pitch tables are built from, copied together so that a table is never built from part of a change
+	*/
+	struct PitchInputs
+	{
+		jr::PitchTable::Mode mode{ jr::PitchTable::Mode::linear };
+		float rootNote{ 36.0f };
+		float transposition{ 0.0f };
+		std::array<std::pair<float, float>, maxNumLayers> ranges{};		// each layer's min and max frequency in Hz
+	};
+
+	/*
+	Copies the pitch mode, root, transposition and every layer's range for the pitch tables to be built from, and marks the
+	tables as out of date. Never waits: if a table is being built, it is left pending and tried again at the start of the next
+	block.
+	*/
+	void publishPitchInputs();
 
 	/*
-	* returns a new randomised Osc Freq value in Hz using the current max and min values.
+	Builds the set of pitch tables with the given index from the published pitch inputs and the scale
 	*/
-	float getRandomOscFrequency() { return (random.nextFloat() * (maxOscFreq - minOscFreq)) + minOscFreq; };
+	void fillPitchTable(int index);
 
-	void processSharedLevels();
+	/*
+	Starts picking frequencies from the latest pitch table. Called by the thread that processes at the start of each block.
+	*/
+	void adoptPitchTable()
+	{
+		activePitchTable = latestPitchTable.load();
+		updatePitchTableRatio();
+	}
 
-	void setMaxLevel(float _maxLevel);
+	/*
+	Works out the ratio that moves frequencies picked from the active tables by any transposition made since they were built.
+	Every pitch mode scales with its root and range, so this gives the same frequencies a rebuilt table would.
+	*/
+	void updatePitchTableRatio()
+	{
+		auto semitones = transposition.load() - pitchTableTranspositions[(size_t)activePitchTable.load()];
+		pitchTableRatio = semitones == 0.0f ? 1.0f : std::pow(2.0f, semitones / 12.0f);
+	}
+
+	/*
+	Fills the level buffer with the next numSamples values of the layer's shared max level
+	*/
+	void processSharedLevels(int layer, int numSamples);
+
+	void setMaxLevel(int layer, float _maxLevel);
+
+	/*
+	Returns the LFO frequency in Hz for a scale value between 0 and 1, within the range set by the layer's LFO rate
+	*/
+	float getLfoFreqFromScale(int layer, float scale);
 
 	// variables that are referenced by the list of RandomOsc objects
 	float rampTime{ 0.05f };
 	juce::Random random;						// used for generating random frequency
-	float lfoRate{ 0.0f };						// rate to modify the LFO freq by (0-1)
+	std::array<Layer, maxNumLayers> layers;
 	float minLfoFreq{ 0.01f };					// minimum lfo frequency when generating random in Hz
 	float maxLfoFreq{ 5.0f };					// maximum lfo frequency when picking a random frequency in Hz
-	float minOscFreq{ 120.0f };					// minimum osc frequency when generating random in Hz
-	float maxOscFreq{ 1200.0f };				// maximum osc frequency when picking a random frequency in Hz
-	float stereoWidth{ 0.0f };					// pan range 0 - 1.0
-	juce::SmoothedValue<float> maxLevel{};		// the maximum combined level of each osc fader - will be referenced by all oscillators
-	float normalRatio{ 1.0f };					// the factor to multiply current osc level by to get level in range of 0-1. Saving to avoid unecessary calculation repetition
-	float waveShape{ 0.0f };					// waveShape to be used by oscialltors, 0=Sine, 1=Tri
+	std::atomic<jr::PitchTable::Mode> pitchMode{ jr::PitchTable::Mode::linear };	// how osc frequencies are spread over the range
+	std::atomic<float> rootNote{ 36.0f };		// MIDI note that harmonics and scales are built on
+	std::atomic<float> transposition{ 0.0f };	// semitones that the root and range have been moved by from MIDI
+	std::atomic<float> glideTime{ 0.5f };		// seconds voices take to glide when the root is moved
+	jr::PitchTable::Scale scale;				// scale for the Scala pitch mode, guarded by scaleLock
+	juce::SpinLock scaleLock;
+	PitchInputs publishedPitchInputs;			// the pitch inputs the tables are built from, guarded by scaleLock
+	std::atomic<bool> pitchInputsPending{ false };	// true if a change to the pitch inputs couldn't be published yet
+	std::array<std::array<jr::PitchTable, maxNumLayers>, 2> pitchTables;	// a table for each layer, picked from in one set while the other is built
+	std::atomic<int> latestPitchTable{ 0 };		// index of the set of tables that was built last
+	std::atomic<int> activePitchTable{ 0 };		// index of the set the thread that processes is picking from
+	std::array<float, 2> pitchTableTranspositions{};	// transposition each set of tables was built for, written along with the set
+	float pitchTableRatio{ 1.0f };				// applied to picked frequencies until the tables catch up with the transposition
+	std::atomic<int> pitchVersion{ 0 };			// increased whenever the pitch table needs rebuilding
+	std::atomic<int> pitchTableVersion{ -1 };	// version of the settings the latest pitch table was built from
+	std::atomic<jr::VoiceFade::Curve> fadeCurve{ jr::VoiceFade::Curve::raisedCosine };	// curve voices are faded in and out along
+	jr::Panner panner;							// converts osc pan values into output channel gains
+	juce::SharedResourcePointer<jr::SharedResources> resources;	// sine table shared with every other instance
+	juce::AudioBuffer<float> voiceBuffer;		// scratch buffer each osc renders into before it is mixed
+	juce::AudioBuffer<float> levelBuffer;		// max level for each sample of the current block, shared by all oscs of a layer
+	juce::AudioBuffer<float> fadeBuffer;		// fade gain, then level, for each sample of the current block of the osc being rendered
+	bool renderingMono{ false };				// true if the layer being rendered should mix unpanned into a single channel this block
 
 };
 
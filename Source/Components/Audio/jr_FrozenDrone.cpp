@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    jr_FrozenDrone.cpp
+    Created: 19 Oct 2026 2:14:37pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_FrozenDrone.h"
+
+jr::FrozenDrone::FrozenDrone(std::function<FaderPairs::Settings()> _getSettings, int _maxNumOscs, int _maxNumPartials)
+	: juce::Thread("Frozen drone render"), getSettings(std::move(_getSettings)), maxNumOscs(_maxNumOscs), maxNumPartials(_maxNumPartials)
+{
+}
+
+jr::FrozenDrone::~FrozenDrone()
+{
+	stopThread(4000);
+}
+
+void jr::FrozenDrone::prepare(double _sampleRate, int samplesPerBlock, const juce::AudioChannelSet& _layout)
+{
+	// the loops are about to be reallocated, so any render in progress has to finish first
+	stopThread(4000);
+
+	sampleRate = _sampleRate;
+	layout = _layout;
+	int numChannels = juce::jmax(1, layout.size());
+
+	loopLength = (int)(loopSeconds * sampleRate);
+	crossfadeLength = juce::jmax(1, (int)(crossfadeSeconds * sampleRate));
+	minSegmentLength = (int)(minSegmentSeconds * sampleRate);
+	maxSegmentLength = (int)(maxSegmentSeconds * sampleRate);
+
+	for (auto& loop : loops)
+	{
+		loop.setSize(numChannels, loopLength);
+	}
+	frozenBuffer.setSize(numChannels, juce::jmax(1, samplesPerBlock));
+
+	readyIndex = -1;
+	readyGeneration = -1;
+	playingIndex = -1;
+	playingGeneration = -1;
+	generation++;
+
+	frozenMix.reset(sampleRate, crossfadeSeconds);
+	frozenMix.setCurrentAndTargetValue(0.0f);
+
+	startThread(juce::Thread::Priority::low);
+}
+
+void jr::FrozenDrone::setEnabled(bool shouldBeEnabled)
+{
+	enabled = shouldBeEnabled;
+	notify();
+}
+
+void jr::FrozenDrone::invalidate()
+{
+	generation++;
+	notify();
+}
+
+void jr::FrozenDrone::setTransposition(float semitones)
+{
+	if (semitones != transposition.exchange(semitones))
+	{
+		invalidate();
+	}
+}
+
+void jr::FrozenDrone::setScale(const PitchTable::Scale& _scale)
+{
+	{
+		const juce::SpinLock::ScopedLockType lock(handoverLock);
+		scale = _scale;
+	}
+	invalidate();
+}
+
+void jr::FrozenDrone::process(juce::AudioBuffer<float>& buffer, FaderPairs& live)
+{
+	updatePlayback();
+
+	if (playingIndex.load() < 0)
+	{
+		live.process(buffer);
+		return;
+	}
+
+	if (!frozenMix.isSmoothing() && frozenMix.getCurrentValue() == 1.0f)
+	{
+		readLoop(buffer);
+		return;
+	}
+
+	// crossfading between live and frozen, so both have to be rendered
+	live.process(buffer);
+
+	int numSamples = buffer.getNumSamples();
+	int numChannels = juce::jmin(buffer.getNumChannels(), frozenBuffer.getNumChannels());
+	auto halfPi = juce::MathConstants<float>::halfPi;
+
+	for (int startSample{}; startSample < numSamples; startSample += frozenBuffer.getNumSamples())
+	{
+		int chunkSize = juce::jmin(frozenBuffer.getNumSamples(), numSamples - startSample);
+		juce::AudioBuffer<float> frozenChunk{ frozenBuffer.getArrayOfWritePointers(), frozenBuffer.getNumChannels(), 0, chunkSize };
+		readLoop(frozenChunk);
+
+		// equal power gains at each end of the chunk, ramped linearly in between
+		auto mixStart = frozenMix.getCurrentValue() * halfPi;
+		auto mixEnd = frozenMix.skip(chunkSize) * halfPi;
+
+		buffer.applyGainRamp(startSample, chunkSize, std::cos(mixStart), std::cos(mixEnd));
+		for (int channel{}; channel < numChannels; channel++)
+		{
+			buffer.addFromWithRamp(channel, startSample, frozenChunk.getReadPointer(channel), chunkSize, std::sin(mixStart), std::sin(mixEnd));
+		}
+	}
+}
+
+void jr::FrozenDrone::run()
+{
+	while (!threadShouldExit())
+	{
+		int renderGeneration = generation.load();
+
+		bool hasLoop{ false };
+		{
+			const juce::SpinLock::ScopedLockType lock(handoverLock);
+			hasLoop = readyIndex >= 0 && readyGeneration == renderGeneration;
+		}
+
+		if (!enabled.load() || hasLoop)
+		{
+			wait(-1);
+			continue;
+		}
+
+		// wait for the settings to stop changing before starting a render
+		wait(settleTimeMs);
+		if (generation.load() != renderGeneration)
+		{
+			continue;
+		}
+
+		render(renderGeneration);
+	}
+}
+
+void jr::FrozenDrone::render(int renderGeneration)
+{
+	// the latest loop may be picked up at any time, and the older one may still be fading out
+	int writeIndex{ -1 };
+	while (writeIndex < 0)
+	{
+		{
+			const juce::SpinLock::ScopedLockType lock(handoverLock);
+			int candidate = readyIndex == 0 ? 1 : 0;
+			if (playingIndex.load() != candidate)
+			{
+				writeIndex = candidate;
+			}
+		}
+
+		if (writeIndex < 0)
+		{
+			wait(50);
+			if (threadShouldExit() || generation.load() != renderGeneration)
+			{
+				return;
+			}
+		}
+	}
+
+	auto& loop = loops[writeIndex];
+	auto settings = getSettings();
+	PitchTable::Scale renderScale;
+	{
+		const juce::SpinLock::ScopedLockType lock(handoverLock);
+		renderScale = scale;
+	}
+
+	// a separate engine with the same settings, so rendering never touches the live voices
+	FaderPairs engine;
+	engine.setOutputLayout(layout);
+	engine.setScale(renderScale);
+	engine.applySettings(settings);
+	engine.setTransposition(transposition.load());
+	engine.buildPitchTable();
+	engine.init(settings.layers[0].numOscs, (float)sampleRate, maxNumOscs, renderBlockSize);
+	engine.initSpectral(settings.numPartials, maxNumPartials);
+	engine.scatterLfoPhases();
+
+	juce::AudioBuffer<float> warmUp(loop.getNumChannels(), renderBlockSize);
+	int warmUpLength = (int)(warmUpSeconds * sampleRate);
+	for (int startSample{}; startSample < warmUpLength; startSample += renderBlockSize)
+	{
+		engine.process(warmUp);
+	}
+
+	for (int startSample{}; startSample < loopLength; startSample += renderBlockSize)
+	{
+		if (threadShouldExit() || !enabled.load() || generation.load() != renderGeneration)
+		{
+			return;
+		}
+
+		juce::AudioBuffer<float> chunk{ loop.getArrayOfWritePointers(), loop.getNumChannels(), startSample, juce::jmin(renderBlockSize, loopLength - startSample) };
+		engine.process(chunk);
+	}
+
+	const juce::SpinLock::ScopedLockType lock(handoverLock);
+	readyIndex = writeIndex;
+	readyGeneration = renderGeneration;
+}
+
+void jr::FrozenDrone::updatePlayback()
+{
+	if (playingIndex.load() >= 0)
+	{
+		bool shouldPlay = enabled.load() && playingGeneration == generation.load();
+		frozenMix.setTargetValue(shouldPlay ? 1.0f : 0.0f);
+
+		if (!shouldPlay && frozenMix.getCurrentValue() == 0.0f)
+		{
+			// finished fading back to the live engine, the loop can be rendered over
+			playingIndex = -1;
+		}
+		return;
+	}
+
+	if (!enabled.load())
+	{
+		return;
+	}
+
+	// never wait on the render thread, if it is handing over a loop try again next block
+	const juce::SpinLock::ScopedTryLockType lock(handoverLock);
+	if (!lock.isLocked() || readyIndex < 0 || readyGeneration != generation.load())
+	{
+		return;
+	}
+
+	playingIndex = readyIndex;
+	playingGeneration = readyGeneration;
+
+	pickNextSegment();
+	segmentStart = nextStart;
+	segmentLength = nextLength;
+	segmentPosition = 0;
+	pickNextSegment();
+
+	frozenMix.setTargetValue(1.0f);
+}
+
+void jr::FrozenDrone::readLoop(juce::AudioBuffer<float>& output)
+{
+	const auto& loop = loops[playingIndex.load()];
+	int numSamples = output.getNumSamples();
+	int numChannels = juce::jmin(output.getNumChannels(), loop.getNumChannels());
+
+	for (int channel{ numChannels }; channel < output.getNumChannels(); channel++)
+	{
+		output.clear(channel, 0, numSamples);
+	}
+
+	int position{};
+	while (position < numSamples)
+	{
+		int fadeStart = segmentLength - crossfadeLength;
+		int numToRead{};
+
+		if (segmentPosition < fadeStart)
+		{
+			numToRead = juce::jmin(numSamples - position, fadeStart - segmentPosition);
+			for (int channel{}; channel < numChannels; channel++)
+			{
+				output.copyFrom(channel, position, loop, channel, segmentStart + segmentPosition, numToRead);
+			}
+		}
+		else
+		{
+			// equal power crossfade into the start of the next segment
+			int fadePosition = segmentPosition - fadeStart;
+			numToRead = juce::jmin(numSamples - position, segmentLength - segmentPosition);
+			for (int channel{}; channel < numChannels; channel++)
+			{
+				auto* out = output.getWritePointer(channel, position);
+				auto* current = loop.getReadPointer(channel, segmentStart + segmentPosition);
+				auto* next = loop.getReadPointer(channel, nextStart + fadePosition);
+
+				for (int i{}; i < numToRead; i++)
+				{
+					auto proportion = ((float)(fadePosition + i) + 0.5f) / (float)crossfadeLength;
+					out[i] = current[i] * resources->getEqualPowerGain(1.0f - proportion) + next[i] * resources->getEqualPowerGain(proportion);
+				}
+			}
+		}
+
+		position += numToRead;
+		segmentPosition += numToRead;
+
+		if (segmentPosition == segmentLength)
+		{
+			// the next segment has already played through the crossfade
+			segmentStart = nextStart;
+			segmentLength = nextLength;
+			segmentPosition = crossfadeLength;
+			pickNextSegment();
+		}
+	}
+}
+
+void jr::FrozenDrone::pickNextSegment()
+{
+	nextLength = juce::jmin(loopLength, minSegmentLength + random.nextInt(juce::jmax(1, maxSegmentLength - minSegmentLength)));
+	nextStart = random.nextInt(juce::jmax(1, loopLength - nextLength + 1));
+}
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    jr_FrozenDrone.h
+    Created: 19 Oct 2026 2:14:37pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include "jr_FaderPairs.h"
+#include "../../Utils/jr_SharedResources.h"
+
+namespace jr
+{
+	/*
+	Freeze mode for long, static drones. When enabled, a background thread renders a loop from a copy of the engine set up
+	with the current settings. Once the loop is ready the output crossfades from the live engine to playback of the loop,
+	and the live engine stops being processed.
+
+	The loop is played as a chain of segments of random length taken from random points in the loop, each joined to the next
+	with an equal power crossfade, so that the loop point is never heard as a repeat.
+
+	Any change to the settings drops back to the live engine straight away, and a new loop is rendered once the settings have
+	stopped changing.
+	*/
+	class FrozenDrone : private juce::Thread
+	{
+	public:
+		/*
+		getSettings is called from the render thread to read the settings the loop should be rendered with, so must be thread safe.
+		*/
+		FrozenDrone(std::function<FaderPairs::Settings()> _getSettings, int _maxNumOscs, int _maxNumPartials);
+		~FrozenDrone() override;
+
+		/*
+		Allocates the loops for the given sample rate and layout and starts the render thread. Call before playing, not while processing.
+		*/
+		void prepare(double _sampleRate, int samplesPerBlock, const juce::AudioChannelSet& _layout);
+
+		/*
+		Turns freeze mode on or off. Turning it on starts a render if there is no loop for the current settings.
+		*/
+		void setEnabled(bool shouldBeEnabled);
+
+		/*
+		Call whenever a setting that changes the sound of the drone has changed. Playback returns to the live engine
+		and the current loop is thrown away.
+		*/
+		void invalidate();
+
+		/*
+		Call while the engine is changing without its parameters changing, such as during a morph, to put off rendering a loop
+		until it has settled. Doesn't wake the render thread, so is safe to call from the audio thread.
+		*/
+		void deferRender() { generation++; }
+
+		/*
+		Sets the scale that loops are rendered with in the Scala pitch mode, and drops back to the live engine as invalidate()
+		does. Call from the message thread.
+		*/
+		void setScale(const PitchTable::Scale& _scale);
+
+		/*
+		Sets the number of semitones MIDI has moved the root and range by, for loops to be rendered with. Drops back to the live
+		engine as invalidate() does if it has changed. Call from the message thread.
+		*/
+		void setTransposition(float semitones);
+
+		/*
+		Replaces the contents of buffer with the output of either the live engine, the frozen loop, or a crossfade between the two.
+		The live engine is only processed while it can be heard.
+		*/
+		void process(juce::AudioBuffer<float>& buffer, FaderPairs& live);
+
+	private:
+		void run() override;
+
+		/*
+		Renders a new loop for the given generation of settings, and hands it over to the audio thread if the settings
+		have not changed by the time it is finished
+		*/
+		void render(int renderGeneration);
+
+		/*
+		Starts or stops loop playback if a new loop is ready, freeze mode has been turned off or the settings have changed
+		*/
+		void updatePlayback();
+
+		/*
+		Replaces the contents of output with the next samples of the playing loop
+		*/
+		void readLoop(juce::AudioBuffer<float>& output);
+
+		/*
+		Picks the start and length of the segment that will be crossfaded to once the current one finishes
+		*/
+		void pickNextSegment();
+
+		static constexpr double loopSeconds = 20.0;			// length of each rendered loop
+		static constexpr double warmUpSeconds = 0.5;		// rendered and thrown away while the voices fade in
+		static constexpr double minSegmentSeconds = 6.0;	// shortest section of the loop played before crossfading
+		static constexpr double maxSegmentSeconds = 12.0;	// longest section of the loop played before crossfading
+		static constexpr double crossfadeSeconds = 2.0;		// length of the crossfade between segments
+		static constexpr int settleTimeMs = 500;			// settings must stop changing for this long before a render starts
+		static constexpr int renderBlockSize = 512;
+
+		std::function<FaderPairs::Settings()> getSettings;
+		int maxNumOscs{};
+		int maxNumPartials{};
+		double sampleRate{ 44100.0 };
+		juce::AudioChannelSet layout;
+
+		juce::AudioBuffer<float> loops[2];						// rendered loops, one can be played while the other is rendered
+		juce::SharedResourcePointer<SharedResources> resources;	// equal power curve for the crossfades
+		juce::AudioBuffer<float> frozenBuffer;					// loop output while it is being crossfaded with the live engine
+		int loopLength{};
+		int crossfadeLength{};
+		int minSegmentLength{};
+		int maxSegmentLength{};
+
+		juce::SpinLock handoverLock;							// held while a loop is being handed to or picked up from the audio thread
+		int readyIndex{ -1 };									// index of the latest finished loop, guarded by handoverLock
+		int readyGeneration{ -1 };								// generation of settings the latest loop was rendered with, guarded by handoverLock
+		PitchTable::Scale scale;								// scale for the Scala pitch mode, guarded by handoverLock
+		std::atomic<float> transposition{ 0.0f };				// semitones the root and range are moved by
+		std::atomic<int> playingIndex{ -1 };					// index of the loop the audio thread is reading, -1 when live
+		std::atomic<int> generation{ 0 };						// increased every time the settings change
+		std::atomic<bool> enabled{ false };
+
+		// audio thread only
+		int playingGeneration{ -1 };							// generation of the loop being played
+		juce::SmoothedValue<float> frozenMix{ 0.0f };			// crossfade between live and frozen, 0=Live 1=Frozen
+		juce::Random random;									// picks the segments of the loop to play
+		int segmentStart{};										// loop position of the current segment
+		int segmentLength{};
+		int segmentPosition{};									// samples played of the current segment
+		int nextStart{};										// loop position of the segment that will be crossfaded to
+		int nextLength{};
+	};
+}
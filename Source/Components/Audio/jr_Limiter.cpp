@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    jr_Limiter.cpp
+    Created: 22 Oct 2026 9:26:31am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_Limiter.h"
+#include <cmath>
+
+void jr::Limiter::prepare(double sampleRate, int numChannels, int samplesPerBlock)
+{
+	// windowed sinc interpolation at each quarter sample, normalised so that each phase has unity gain at DC
+	auto halfTwoPi = juce::MathConstants<double>::twoPi * 0.5;
+	for (int phase{}; phase < numPhases; phase++)
+	{
+		double sum = 0.0;
+		std::array<double, numTaps> taps;
+		for (int tap{}; tap < numTaps; tap++)
+		{
+			auto x = (double)(filterDelay - tap) - (double)phase / (double)numPhases;
+			auto sinc = x == 0.0 ? 1.0 : std::sin(halfTwoPi * x) / (halfTwoPi * x);
+			auto window = 0.5 * (1.0 + std::cos(halfTwoPi * x / ((double)filterDelay + 0.5)));
+			taps[tap] = sinc * window;
+			sum += taps[tap];
+		}
+		for (int tap{}; tap < numTaps; tap++)
+		{
+			phaseTaps[phase][tap] = (float)(taps[tap] / sum);
+		}
+	}
+
+	ceiling = juce::Decibels::decibelsToGain(ceilingDb);
+	releaseCoefficient = (float)(1.0 - std::exp(-1.0 / (releaseSeconds * sampleRate)));
+	lookahead = juce::jmax(1, (int)std::ceil(lookaheadSeconds * sampleRate));
+	latency = lookahead + filterDelay;
+	historySize = juce::jmax(latency, numTaps);
+	maxChunkSize = juce::jmax(1, samplesPerBlock);
+
+	lines.setSize(juce::jmax(1, numChannels), historySize + maxChunkSize);
+	scratch.setSize(3, maxChunkSize);
+	minValues.resize((size_t)lookahead + 1);
+	minTimes.resize((size_t)lookahead + 1);
+	averageRing.resize((size_t)lookahead);
+
+	reset();
+}
+
+void jr::Limiter::reset()
+{
+	lines.clear();
+	minHead = 0;
+	minSize = 0;
+	sampleCount = 0;
+	releasedGain = 1.0f;
+	std::fill(averageRing.begin(), averageRing.end(), 1.0f);
+	averageIndex = 0;
+	averageSum = (double)lookahead;
+}
+
+void jr::Limiter::process(juce::AudioBuffer<float>& buffer)
+{
+	bool shouldLimit = enabled.load();
+	if (shouldLimit != wasEnabled)
+	{
+		wasEnabled = shouldLimit;
+		if (shouldLimit)
+		{
+			reset();
+		}
+	}
+
+	if (!shouldLimit || buffer.getNumChannels() > lines.getNumChannels() || maxChunkSize == 0)
+	{
+		return;
+	}
+
+	for (int start{}; start < buffer.getNumSamples(); start += maxChunkSize)
+	{
+		processChunk(buffer, start, juce::jmin(maxChunkSize, buffer.getNumSamples() - start));
+	}
+}
+
+void jr::Limiter::processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+	int numChannels = buffer.getNumChannels();
+
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		juce::FloatVectorOperations::copy(lines.getWritePointer(channel, historySize), buffer.getReadPointer(channel, startSample), numSamples);
+	}
+
+	detectPeaks(numChannels, numSamples);
+
+	const float* peaks = scratch.getReadPointer(0);
+	float* gains = scratch.getWritePointer(2);
+	auto averageScale = 1.0 / (double)lookahead;
+
+	for (int i{}; i < numSamples; i++)
+	{
+		auto requiredGain = peaks[i] > ceiling ? ceiling / peaks[i] : 1.0f;
+		auto heldGain = pushSlidingMinimum(requiredGain);
+
+		releasedGain = juce::jmin(heldGain, releasedGain + (1.0f - releasedGain) * releaseCoefficient);
+
+		averageSum += (double)releasedGain - (double)averageRing[averageIndex];
+		averageRing[averageIndex] = releasedGain;
+		averageIndex = (averageIndex + 1) % lookahead;
+
+		gains[i] = (float)(averageSum * averageScale);
+	}
+
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		float* line = lines.getWritePointer(channel);
+		juce::FloatVectorOperations::multiply(buffer.getWritePointer(channel, startSample), line + historySize - latency, gains, numSamples);
+
+		// keep the end of this chunk as history for the next
+		std::copy(line + numSamples, line + numSamples + historySize, line);
+	}
+}
+
+void jr::Limiter::detectPeaks(int numChannels, int numSamples)
+{
+	float* peaks = scratch.getWritePointer(0);
+	float* oversampled = scratch.getWritePointer(1);
+
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		const float* input = lines.getReadPointer(channel, historySize);
+
+		// phase 0 is the input delayed by the filter, so it needs no filtering
+		if (channel == 0)
+		{
+			juce::FloatVectorOperations::abs(peaks, input - filterDelay, numSamples);
+		}
+		else
+		{
+			juce::FloatVectorOperations::abs(oversampled, input - filterDelay, numSamples);
+			juce::FloatVectorOperations::max(peaks, peaks, oversampled, numSamples);
+		}
+
+		for (int phase{ 1 }; phase < numPhases; phase++)
+		{
+			juce::FloatVectorOperations::multiply(oversampled, input, phaseTaps[phase][0], numSamples);
+			for (int tap{ 1 }; tap < numTaps; tap++)
+			{
+				juce::FloatVectorOperations::addWithMultiply(oversampled, input - tap, phaseTaps[phase][tap], numSamples);
+			}
+
+			juce::FloatVectorOperations::abs(oversampled, oversampled, numSamples);
+			juce::FloatVectorOperations::max(peaks, peaks, oversampled, numSamples);
+		}
+	}
+}
+
+float jr::Limiter::pushSlidingMinimum(float requiredGain)
+{
+	int capacity = (int)minValues.size();
+
+	// drop the oldest value once it is more than the lookahead behind, which makes room for the new one
+	if (minSize > 0 && minTimes[minHead] < sampleCount - lookahead)
+	{
+		minHead = (minHead + 1) % capacity;
+		minSize--;
+	}
+
+	// values that are no smaller than the new one can never be the minimum again
+	while (minSize > 0 && minValues[(minHead + minSize - 1) % capacity] >= requiredGain)
+	{
+		minSize--;
+	}
+
+	int back = (minHead + minSize) % capacity;
+	minValues[back] = requiredGain;
+	minTimes[back] = sampleCount;
+	minSize++;
+
+	sampleCount++;
+	return minValues[minHead];
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    jr_Limiter.h
+    Created: 22 Oct 2026 9:26:31am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace jr
+{
+	/*
+	A lookahead true-peak limiter for the end of the output chain. Every channel is delayed by getLatencySamples() and shares
+	one gain, so the image of panned voices doesn't move when the limiter works.
+
+	Peaks are detected on a 4x oversampled estimate of the signal, so that peaks between samples are caught as well. The
+	oversampling filter is run one tap at a time across the whole block with FloatVectorOperations, so the detector is
+	vectorised; only the gain smoothing runs per sample. The required gain is held for the lookahead time with a sliding minimum,
+	released with a one-pole smoother, then averaged over the lookahead time, so the gain has always fully reached its target
+	by the time a peak leaves the delay line.
+
+	Per sample the detector costs 24 vectorised multiply-adds and 4 abs/max passes for each channel, and the gain path one scalar
+	pass shared by all channels. The budget is under 5% of rendering 100 voices, which the limiter case of the benchmark in
+	Benchmarks/ checks.
+	*/
+	class Limiter
+	{
+	public:
+		/*
+		Sets the lookahead time for the sample rate and allocates the delay lines and scratch buffers. Call before playing, not
+		while processing.
+		*/
+		void prepare(double sampleRate, int numChannels, int samplesPerBlock);
+
+		/*
+		Turns the limiter on or off. Takes effect at the start of the next block, and the delay lines are cleared when it is
+		turned on so no stale audio is played.
+		*/
+		void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+
+		bool isEnabled() const { return enabled.load(); }
+
+		/*
+		Returns the latency added while the limiter is on
+		*/
+		int getLatencySamples() const { return latency; }
+
+		/*
+		Limits buffer in place. Does nothing while the limiter is off.
+		*/
+		void process(juce::AudioBuffer<float>& buffer);
+
+	private:
+		/*
+		Clears the delay lines and gain state
+		*/
+		void reset();
+
+		/*
+		Limits numSamples of buffer starting at startSample, which must fit in the scratch buffers
+		*/
+		void processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+		/*
+		Fills the detector buffer with the highest 4x oversampled absolute level of any channel at each sample
+		*/
+		void detectPeaks(int numChannels, int numSamples);
+
+		/*
+		Returns the smallest required gain over the last lookahead window, after adding requiredGain
+		*/
+		float pushSlidingMinimum(float requiredGain);
+
+		static constexpr int numPhases = 4;								// oversampling factor of the peak detector
+		static constexpr int numTaps = 8;								// taps per phase of the oversampling filter
+		static constexpr int filterDelay = numTaps / 2;					// delay of the oversampled estimate in samples
+		static constexpr float ceilingDb = -1.0f;						// highest true-peak level let through
+		static constexpr double lookaheadSeconds = 0.0015;
+		static constexpr double releaseSeconds = 0.1;
+
+		std::atomic<bool> enabled{ false };
+		bool wasEnabled{ false };										// the value of enabled in the last block
+
+		std::array<std::array<float, numTaps>, numPhases> phaseTaps{};	// oversampling filter, phase 0 is a pure delay
+		float ceiling{ 0.891f };
+		float releaseCoefficient{ 0.0f };
+		int lookahead{ 1 };												// samples the gain takes to reach its target
+		int latency{ 0 };												// lookahead plus the detector's filter delay
+		int historySize{ 0 };											// samples from previous blocks kept at the start of each line
+		int maxChunkSize{ 0 };
+
+		juce::AudioBuffer<float> lines;									// per channel, historySize old samples followed by the current chunk
+		juce::AudioBuffer<float> scratch;								// detector output, oversampled phase and gain for each sample
+
+		std::vector<float> minValues;									// sliding minimum as a monotonic queue in a ring, oldest first
+		std::vector<juce::int64> minTimes;								// sample each queued value was added at
+		int minHead{ 0 };
+		int minSize{ 0 };
+		juce::int64 sampleCount{ 0 };									// samples processed since reset
+		float releasedGain{ 1.0f };
+		std::vector<float> averageRing;									// the last lookahead released gains, summed for the average
+		int averageIndex{ 0 };
+		double averageSum{ 0.0 };
+	};
+}
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    jr_LookaheadRenderer.cpp
+    Created: 19 Oct 2026 4:03:19pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_LookaheadRenderer.h"
+
+jr::LookaheadRenderer::LookaheadRenderer(std::function<void(juce::AudioBuffer<float>&)> _renderBlock)
+	: juce::Thread("Lookahead render"), renderBlock(std::move(_renderBlock))
+{
+}
+
+jr::LookaheadRenderer::~LookaheadRenderer()
+{
+	release();
+}
+
+void jr::LookaheadRenderer::prepare(int numChannels, int samplesPerBlock)
+{
+	release();
+
+	blockSize = juce::jmax(1, samplesPerBlock);
+	numChannels = juce::jmax(1, numChannels);
+
+	// one spare block so the thread can always write a whole block while the lookahead is topped up
+	fifo.setTotalSize(getLatencySamples() + blockSize + 1);
+	ring.setSize(numChannels, fifo.getTotalSize());
+	renderBuffer.setSize(numChannels, blockSize);
+
+	startThread(juce::Thread::Priority::highest);
+}
+
+void jr::LookaheadRenderer::release()
+{
+	stopThread(1000);
+	active = false;
+	threadBusy = false;
+	fifo.reset();
+}
+
+void jr::LookaheadRenderer::process(juce::AudioBuffer<float>& buffer)
+{
+	int numSamples = buffer.getNumSamples();
+
+	if (active.load())
+	{
+		if (enabled.load())
+		{
+			int numRead = readFromFifo(buffer, 0, numSamples);
+			if (numRead < numSamples)
+			{
+				// the thread fell behind, better a gap than blocking the callback
+				buffer.clear(numRead, numSamples - numRead);
+			}
+			notify();
+			return;
+		}
+
+		// stop the thread starting any more blocks, then play out what it has already rendered
+		active = false;
+	}
+
+	int numRead = readFromFifo(buffer, 0, numSamples);
+	if (numRead < numSamples)
+	{
+		if (threadBusy.load())
+		{
+			// the thread is finishing its last block, so the engine can't be used here yet
+			buffer.clear(numRead, numSamples - numRead);
+			return;
+		}
+
+		juce::AudioBuffer<float> remaining{ buffer.getArrayOfWritePointers(), buffer.getNumChannels(), numRead, numSamples - numRead };
+		renderBlock(remaining);
+	}
+
+	if (enabled.load() && fifo.getNumReady() == 0 && !threadBusy.load() && isThreadRunning())
+	{
+		// render the lookahead once here so the output carries on without a gap, then hand over to the thread
+		renderIntoFifo(getLatencySamples());
+		active = true;
+		notify();
+	}
+}
+
+void jr::LookaheadRenderer::run()
+{
+	while (!threadShouldExit())
+	{
+		threadBusy = true;
+		while (active.load() && !threadShouldExit() && fifo.getNumReady() + blockSize <= getLatencySamples())
+		{
+			renderIntoFifo(blockSize);
+		}
+		threadBusy = false;
+
+		wait(100);
+	}
+}
+
+void jr::LookaheadRenderer::renderIntoFifo(int numSamples)
+{
+	for (int rendered{}; rendered < numSamples; rendered += blockSize)
+	{
+		int numToRender = juce::jmin(blockSize, numSamples - rendered, fifo.getFreeSpace());
+		if (numToRender <= 0)
+		{
+			return;
+		}
+
+		juce::AudioBuffer<float> block{ renderBuffer.getArrayOfWritePointers(), renderBuffer.getNumChannels(), 0, numToRender };
+		renderBlock(block);
+
+		int start1, size1, start2, size2;
+		fifo.prepareToWrite(numToRender, start1, size1, start2, size2);
+		for (int channel{}; channel < ring.getNumChannels(); channel++)
+		{
+			if (size1 > 0)
+				ring.copyFrom(channel, start1, block, channel, 0, size1);
+			if (size2 > 0)
+				ring.copyFrom(channel, start2, block, channel, size1, size2);
+		}
+		fifo.finishedWrite(size1 + size2);
+	}
+}
+
+int jr::LookaheadRenderer::readFromFifo(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+	int numChannels = juce::jmin(buffer.getNumChannels(), ring.getNumChannels());
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		if (size1 > 0)
+			buffer.copyFrom(channel, startSample, ring, channel, start1, size1);
+		if (size2 > 0)
+			buffer.copyFrom(channel, startSample + size1, ring, channel, start2, size2);
+	}
+	for (int channel{ numChannels }; channel < buffer.getNumChannels(); channel++)
+	{
+		buffer.clear(channel, startSample, size1 + size2);
+	}
+
+	fifo.finishedRead(size1 + size2);
+	return size1 + size2;
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    jr_LookaheadRenderer.h
+    Created: 19 Oct 2026 4:03:19pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+namespace jr
+{
+	/*
+	Runs a render function either directly in the audio callback, or on a dedicated thread that stays a couple of blocks ahead
+	of the callback and writes into a lock-free FIFO. In lookahead mode the callback only copies out of the FIFO, so spikes in
+	render time are absorbed by the FIFO instead of causing dropouts, at the cost of getLatencySamples() of latency.
+
+	Switching between modes happens in the callback without a gap: when switching on, the callback renders the lookahead itself
+	once before handing over to the thread; when switching off, it plays out what is left in the FIFO before rendering directly.
+	*/
+	class LookaheadRenderer : private juce::Thread
+	{
+	public:
+		/*
+		renderBlock must replace the contents of the buffer it is given with the next samples. It is only ever called from one
+		thread at a time.
+		*/
+		LookaheadRenderer(std::function<void(juce::AudioBuffer<float>&)> _renderBlock);
+		~LookaheadRenderer() override;
+
+		/*
+		Allocates the FIFO and starts the render thread. Call before playing, not while processing.
+		*/
+		void prepare(int numChannels, int samplesPerBlock);
+
+		/*
+		Stops the render thread
+		*/
+		void release();
+
+		/*
+		Turns lookahead rendering on or off. Takes effect at the start of the next block.
+		*/
+		void setEnabled(bool shouldBeEnabled) { enabled = shouldBeEnabled; }
+
+		bool isEnabled() const { return enabled.load(); }
+
+		/*
+		Returns the latency added while lookahead rendering is on
+		*/
+		int getLatencySamples() const { return numBlocksAhead * blockSize; }
+
+		/*
+		Replaces the contents of buffer with the next samples, either from the FIFO or by rendering them directly
+		*/
+		void process(juce::AudioBuffer<float>& buffer);
+
+	private:
+		void run() override;
+
+		/*
+		Renders numSamples in blocks and adds them to the FIFO
+		*/
+		void renderIntoFifo(int numSamples);
+
+		/*
+		Copies up to numSamples from the FIFO into buffer starting at startSample, returning the number copied
+		*/
+		int readFromFifo(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+		static constexpr int numBlocksAhead = 2;
+
+		std::function<void(juce::AudioBuffer<float>&)> renderBlock;
+		int blockSize{ 512 };
+		juce::AbstractFifo fifo{ 1 };
+		juce::AudioBuffer<float> ring;							// samples rendered ahead of the callback, indexed by fifo
+		juce::AudioBuffer<float> renderBuffer;					// one block, rendered before being written to the ring
+
+		std::atomic<bool> enabled{ false };						// lookahead rendering has been requested
+		std::atomic<bool> active{ false };						// the thread is allowed to render, only changed by the callback
+		std::atomic<bool> threadBusy{ false };					// the thread may be inside renderBlock
+	};
+}
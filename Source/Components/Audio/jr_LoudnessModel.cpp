@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    jr_LoudnessModel.cpp
+    Created: 21 Oct 2026 4:40:13pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_LoudnessModel.h"
+#include <cmath>
+
+void jr::LoudnessModel::prepare(const jr::Panner& panner, int maxNumVoices)
+{
+	auto targetRms = juce::Decibels::decibelsToGain(targetLevelDb);
+
+	// each voice is at 1 / numVoices, so numVoices incoherent voices have a mean square of lfoMeanSquare / numVoices.
+	// No voices is treated as one so that the last voices can fade out without the gain dropping under them.
+	voiceGains.resize((size_t)juce::jmax(1, maxNumVoices) + 1);
+	for (int numVoices{}; numVoices < (int)voiceGains.size(); numVoices++)
+	{
+		voiceGains[numVoices] = targetRms * std::sqrt((float)juce::jmax(1, numVoices) / lfoMeanSquare);
+	}
+
+	for (int i{}; i < tableSize; i++)
+	{
+		auto proportion = (float)i / (float)(tableSize - 1);
+
+		// the sine and triangle are a quarter cycle apart, so they are uncorrelated and their mean squares (1/2 and 1/3) add
+		auto shapeMeanSquare = 0.5f * (1.0f - proportion) * (1.0f - proportion) + proportion * proportion / 3.0f;
+		shapeGains[i] = 1.0f / std::sqrt(shapeMeanSquare);
+
+		// pan values are spread evenly across 0.5 +/- width / 2
+		jr::Panner::Gains gains;
+		float powerSum = 0.0f;
+		for (int sample{}; sample < numPanSamples; sample++)
+		{
+			auto pan = 0.5f + proportion * (((float)sample + 0.5f) / (float)numPanSamples - 0.5f);
+			panner.getGains(pan, gains);
+			for (int channel{}; channel < panner.getNumChannels(); channel++)
+			{
+				powerSum += gains[channel] * gains[channel];
+			}
+		}
+		auto channelPower = powerSum / (float)(numPanSamples * panner.getNumChannels());
+		panGains[i] = channelPower > 0.0f ? 1.0f / std::sqrt(channelPower) : 1.0f;
+	}
+}
+
+float jr::LoudnessModel::getGain(int numVoices, float waveShape, float stereoWidth) const
+{
+	if (voiceGains.empty())
+	{
+		return 0.0f;
+	}
+
+	auto voiceGain = voiceGains[juce::jlimit(0, (int)voiceGains.size() - 1, numVoices)];
+	return voiceGain * lookup(shapeGains, waveShape) * lookup(panGains, stereoWidth);
+}
+
+float jr::LoudnessModel::lookup(const Table& table, float proportion)
+{
+	auto position = juce::jlimit(0.0f, 1.0f, proportion) * (float)(tableSize - 1);
+	auto index = juce::jmin((int)position, tableSize - 2);
+	auto fraction = position - (float)index;
+	return table[index] + (table[index + 1] - table[index]) * fraction;
+}
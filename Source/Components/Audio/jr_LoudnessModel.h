@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    jr_LoudnessModel.h
+    Created: 21 Oct 2026 4:40:13pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <vector>
+#include "jr_Panner.h"
+
+namespace jr
+{
+	/*
+	Works out the gain that brings the oscillator engine to a constant expected RMS level per output channel, whatever the
+	number of voices, wave shape, stereo width and speaker layout.
+
+	Each voice is an oscillator at 1 / numVoices of full level, scaled by an LFO between 0 and 1. The LFOs and frequencies of
+	different voices are unrelated, so the voices are incoherent and their powers add, giving an expected mean square of:
+
+		numVoices * (1 / numVoices)^2 * lfoMeanSquare * shapeMeanSquare(waveShape) * panPower(stereoWidth) / numChannels
+
+	where panPower is the sum of the squared channel gains, averaged over the spread of pan values for the stereo width.
+	Each factor is tabulated in prepare() so that getGain() is just lookups and interpolation.
+	*/
+	class LoudnessModel
+	{
+	public:
+		/*
+		Builds the tables for the current layout of panner. Call before playing and whenever the layout changes, not while processing.
+		*/
+		void prepare(const jr::Panner& panner, int maxNumVoices);
+
+		/*
+		Returns the gain to apply to the summed voices for the given settings
+		*/
+		float getGain(int numVoices, float waveShape, float stereoWidth) const;
+
+	private:
+		static constexpr int tableSize = 65;
+		static constexpr int numPanSamples = 256;			// pan positions averaged for each stereo width
+		static constexpr float targetLevelDb = -28.0f;		// expected RMS per output channel
+		static constexpr float lfoMeanSquare = 0.375f;		// mean of ((sin + 1) / 2)^2 over a cycle
+
+		using Table = std::array<float, tableSize>;
+
+		/*
+		Returns the value of table at proportion (0 - 1) along it, interpolating between neighbouring entries
+		*/
+		static float lookup(const Table& table, float proportion);
+
+		std::vector<float> voiceGains;						// indexed by number of voices
+		Table shapeGains{};									// indexed by wave shape 0 - 1
+		Table panGains{};									// indexed by stereo width 0 - 1
+	};
+}
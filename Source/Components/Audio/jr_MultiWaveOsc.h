@@ -33,6 +33,32 @@ namespace jr
                 sine.setFrequency(_frequency);
         }
 
+        /*
+        Glides both shapes to the given frequency over the glide time
+        */
+        void setFrequencyOverTime(float _frequency)
+        {
+            tri.setFrequencyOverTime(_frequency);
+            sine.setFrequencyOverTime(_frequency);
+        }
+
+        /*
+        Sets the time setFrequencyOverTime() takes. A glide in progress jumps to its end.
+        */
+        void setGlideTime(float seconds)
+        {
+            tri.setRampTime(seconds);
+            sine.setRampTime(seconds);
+        }
+
+        /*
+        Sets the shared resources whose sine table the sine osc reads from
+        */
+        void setSineTable(const jr::SharedResources* resources)
+        {
+            sine.setTable(resources);
+        }
+
         /*
         Sets the wave shape of the osc 0=Sine 1=Triangle
         Any value between 0 and 1 will mix the outputs of both shapes proportional to the value
@@ -42,12 +68,42 @@ namespace jr
             shapeFactor.setTargetValue(jr::Utils::constrainFloat(_shape));
         }
 
+        /*
+        Sets the wave shape straight away, without smoothing
+        */
+        void setWaveShapeImmediately(float _shape)
+        {
+            shapeFactor.setCurrentAndTargetValue(jr::Utils::constrainFloat(_shape));
+        }
+
+        /*
+        Sets the phase of both shapes, which always run in step
+        */
+        void setPhase(float _phase)
+        {
+            tri.setPhase(_phase);
+            sine.setPhase(_phase);
+        }
+
+        float getPhase() { return sine.getPhase(); }
+
         float process()
         {
-            shapeFactor.getNextValue();
-            float sineOut = sine.process() * (1.0f - shapeFactor.getCurrentValue());
-            float triOut = tri.process() * shapeFactor.getCurrentValue();
-            return sineOut + triOut;
+            float shape = shapeFactor.getNextValue();
+
+            // at either end only one shape is heard, the other just has to keep its phase in step
+            if (shape == 0.0f)
+            {
+                tri.advance();
+                return sine.process();
+            }
+            if (shape == 1.0f)
+            {
+                sine.advance();
+                return tri.process();
+            }
+
+            return sine.process() * (1.0f - shape) + tri.process() * shape;
         }
 
         float getCurrentFrequency()
@@ -55,11 +111,16 @@ namespace jr
             return sine.getCurrentFrequency();
         }
 
+        float getTargetFrequency()
+        {
+            return sine.getTargetFrequency();
+        }
+
         float getWaveShape() { return shapeFactor.getCurrentValue(); }
 
     private:
         TriOsc tri{};
         SineOsc sine{};
-        juce::SmoothedValue<float> shapeFactor{ 0.0f };
+        jr::Smoother shapeFactor{ 0.0f };
     };
 }
\ No newline at end of file
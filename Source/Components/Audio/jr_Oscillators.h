@@ -3,7 +3,9 @@
 #define pi 3.14159
 #include <iostream>
 #include <cmath>		// used for sin() and fabs()
-#include <JuceHeader.h> // used for SmoothedValue
+#include <JuceHeader.h>
+#include "jr_Smoother.h"
+#include "../../Utils/jr_SharedResources.h"
 
 /// <summary>
 /// A simple phasor - use setSampleRate() [default set to 44100Hz] and setFrequency() before calling process()
@@ -19,6 +21,7 @@ public:
 	{
 		sampleRate = _sampleRate;
 		frequency.reset(sampleRate, rampTimeInSeconds);
+		phaseDelta = frequency.getCurrentValue() / sampleRate;
 	}
 
 	/**
@@ -27,6 +30,31 @@ public:
 	void setFrequency(float _frequency)
 	{
 		frequency.setCurrentAndTargetValue(_frequency);
+		phaseDelta = _frequency / sampleRate;
+	}
+
+	/**
+	* sets the current phase, wrapped between 0 and 1
+	*/
+	void setPhase(float _phase)
+	{
+		phase = _phase - std::floor(_phase);
+	}
+
+	/**
+	* returns the current phase, between 0 and 1
+	*/
+	float getPhase()
+	{
+		return phase;
+	}
+
+	/**
+	* returns the amount the phase moves each sample at the current frequency
+	*/
+	float getPhaseDelta()
+	{
+		return phaseDelta;
 	}
 
 	void setFrequencyOverTime(float _frequency) {
@@ -38,13 +66,23 @@ public:
 	*/
 	float process()
 	{
-		phaseDelta = frequency.getNextValue() / (float)sampleRate;
+		advance();
+		return output(phase);
+	}
+
+	/**
+	*  increments the phase without working out the sample value
+	*/
+	void advance()
+	{
+		// the phase delta only needs working out again while the frequency is gliding
+		if (!frequency.isSettled())
+			phaseDelta = frequency.getNextValue() / sampleRate;
+
 		phase += phaseDelta;
 
 		if (phase >= 1)
 			phase -= 1.0f;
-
-		return output(phase);
 	}
 
 	/**
@@ -55,22 +93,34 @@ public:
 		return _phase;
 	}
 
+	/**
+	* sets the time setFrequencyOverTime() takes to reach a new frequency. A glide in progress jumps to its end.
+	*/
 	void setRampTime(float _rampTimeInSeconds) {
 		if (_rampTimeInSeconds < 0.01f) {
 			_rampTimeInSeconds = 0.01f;
 		}
 		rampTimeInSeconds = _rampTimeInSeconds;
+		frequency.reset(sampleRate, rampTimeInSeconds);
+		phaseDelta = frequency.getCurrentValue() / sampleRate;
 	}
 
 	float getCurrentFrequency() {
 		return frequency.getCurrentValue();
 	}
 
+	/**
+	* returns the frequency being glided to, which is the current frequency when not gliding
+	*/
+	float getTargetFrequency() {
+		return frequency.getTargetValue();
+	}
+
 private:
 	float sampleRate = 44100;
-	juce::SmoothedValue<float> frequency;
+	jr::Smoother frequency;
 	float phase = 0;
-	float phaseDelta;
+	float phaseDelta = 0;
 	float rampTimeInSeconds{ 2.0f };
 };
 
@@ -79,15 +129,30 @@ private:
 /// </summary>
 class SineOsc : public Phasor
 {
+public:
+	/**
+	* reads the output from the shared sine table instead of calling sin() every sample. Pass nullptr to go back to sin().
+	*/
+	void setTable(const jr::SharedResources* _table)
+	{
+		table = _table;
+	}
+
+private:
 	/**
 	* returns the next sample value
 	*/
 	float output(float _phase) override
 	{
+		if (table != nullptr)
+			return table->sine(_phase);
+
 		float sample = std::sin(2.0 * pi * _phase);
 
 		return sample;
 	}
+
+	const jr::SharedResources* table = nullptr;
 };
 
 /// <summary>
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    jr_OutputMeter.cpp
+    Created: 21 Oct 2026 2:18:45pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_OutputMeter.h"
+#include <cmath>
+
+void jr::OutputMeter::prepare(double _sampleRate, int numChannels, int samplesPerBlock)
+{
+	sampleRate = _sampleRate;
+
+	// K-weighting coefficients from ITU-R BS.1770, recalculated for the current sample rate
+	auto halfTwoPi = juce::MathConstants<double>::twoPi * 0.5;
+	{
+		double f0 = 1681.974450955533;
+		double gainDb = 3.999843853973347;
+		double q = 0.7071752369554196;
+		double k = std::tan(halfTwoPi * f0 / sampleRate);
+		double vh = std::pow(10.0, gainDb / 20.0);
+		double vb = std::pow(vh, 0.4996667741545416);
+		double a0 = 1.0 + k / q + k * k;
+
+		shelf.b0 = (float)((vh + vb * k / q + k * k) / a0);
+		shelf.b1 = (float)(2.0 * (k * k - vh) / a0);
+		shelf.b2 = (float)((vh - vb * k / q + k * k) / a0);
+		shelf.a1 = (float)(2.0 * (k * k - 1.0) / a0);
+		shelf.a2 = (float)((1.0 - k / q + k * k) / a0);
+	}
+	{
+		double f0 = 38.13547087602444;
+		double q = 0.5003270373238773;
+		double k = std::tan(halfTwoPi * f0 / sampleRate);
+		double a0 = 1.0 + k / q + k * k;
+
+		highPass.b0 = 1.0f;
+		highPass.b1 = -2.0f;
+		highPass.b2 = 1.0f;
+		highPass.a1 = (float)(2.0 * (k * k - 1.0) / a0);
+		highPass.a2 = (float)((1.0 - k / q + k * k) / a0);
+	}
+
+	shelfStates.assign((size_t)numChannels, {});
+	highPassStates.assign((size_t)numChannels, {});
+	scratch.resize((size_t)juce::jmax(1, samplesPerBlock));
+
+	heldPeak = 0.0f;
+	meanSquare = 0.0f;
+	loudnessSlots.fill(0.0f);
+	loudnessSlotIndex = 0;
+	loudnessSlotLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.1));
+	samplesInSlot = 0;
+	numFilledSlots = 0;
+
+	peakDb = minDecibels;
+	rmsDb = minDecibels;
+	shortTermLufs = minDecibels;
+}
+
+void jr::OutputMeter::process(const juce::AudioBuffer<float>& buffer)
+{
+	int numSamples = buffer.getNumSamples();
+	if (buffer.getNumChannels() == 0 || (size_t)buffer.getNumChannels() > shelfStates.size())
+	{
+		return;
+	}
+
+	// split the block so that no chunk is bigger than the scratch buffer or crosses the end of a loudness slot
+	for (int start{}; start < numSamples;)
+	{
+		int chunkSize = juce::jmin(numSamples - start, (int)scratch.size(), loudnessSlotLength - samplesInSlot);
+		processChunk(buffer, start, chunkSize);
+		start += chunkSize;
+	}
+
+	peakDb = juce::Decibels::gainToDecibels(heldPeak, minDecibels);
+	rmsDb = juce::Decibels::gainToDecibels(std::sqrt(meanSquare), minDecibels);
+}
+
+void jr::OutputMeter::processChunk(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+	int numChannels = buffer.getNumChannels();
+	float chunkPeak = 0.0f;
+	float chunkSumOfSquares = 0.0f;
+	float chunkWeightedSumOfSquares = 0.0f;
+
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		const float* input = buffer.getReadPointer(channel, startSample);
+
+		auto range = juce::FloatVectorOperations::findMinAndMax(input, numSamples);
+		chunkPeak = juce::jmax(chunkPeak, range.getEnd(), -range.getStart());
+		chunkSumOfSquares += sumOfSquares(input, numSamples);
+
+		processBiquad(shelf, shelfStates[channel], input, scratch.data(), numSamples);
+		processBiquad(highPass, highPassStates[channel], scratch.data(), scratch.data(), numSamples);
+		chunkWeightedSumOfSquares += sumOfSquares(scratch.data(), numSamples);
+	}
+
+	auto chunkSeconds = (double)numSamples / sampleRate;
+
+	auto peakFall = (float)std::pow(10.0, -peakFallDbPerSecond * chunkSeconds / 20.0);
+	heldPeak = juce::jmax(chunkPeak, heldPeak * peakFall);
+
+	auto chunkMeanSquare = chunkSumOfSquares / (float)(numSamples * numChannels);
+	auto rmsCoefficient = (float)(1.0 - std::exp(-chunkSeconds / rmsTimeSeconds));
+	meanSquare += (chunkMeanSquare - meanSquare) * rmsCoefficient;
+
+	loudnessSlots[loudnessSlotIndex] += chunkWeightedSumOfSquares;
+	samplesInSlot += numSamples;
+
+	if (samplesInSlot >= loudnessSlotLength)
+	{
+		numFilledSlots = juce::jmin(numFilledSlots + 1, numLoudnessSlots);
+
+		float windowSum = 0.0f;
+		for (auto slot : loudnessSlots)
+		{
+			windowSum += slot;
+		}
+
+		// until the first 3 seconds have passed, measure over what there is so the meter responds straight away
+		auto windowMeanSquare = windowSum / (float)(numFilledSlots * loudnessSlotLength);
+		shortTermLufs = windowMeanSquare > 0.0f ? juce::jmax(minDecibels, -0.691f + 10.0f * std::log10(windowMeanSquare)) : minDecibels;
+
+		loudnessSlotIndex = (loudnessSlotIndex + 1) % numLoudnessSlots;
+		loudnessSlots[loudnessSlotIndex] = 0.0f;
+		samplesInSlot = 0;
+	}
+}
+
+void jr::OutputMeter::processBiquad(const Biquad& filter, BiquadState& state, const float* input, float* output, int numSamples)
+{
+	float z1 = state.z1;
+	float z2 = state.z2;
+
+	for (int i{}; i < numSamples; i++)
+	{
+		float in = input[i];
+		float out = filter.b0 * in + z1;
+		z1 = filter.b1 * in - filter.a1 * out + z2;
+		z2 = filter.b2 * in - filter.a2 * out;
+		output[i] = out;
+	}
+
+	// flush denormals that would otherwise build up in the filter during silence
+	state.z1 = std::abs(z1) < 1.0e-15f ? 0.0f : z1;
+	state.z2 = std::abs(z2) < 1.0e-15f ? 0.0f : z2;
+}
+
+float jr::OutputMeter::sumOfSquares(const float* data, int numSamples)
+{
+	using SIMD = juce::dsp::SIMDRegister<float>;
+	constexpr int numLanes = (int)SIMD::SIMDNumElements;
+
+	float sum = 0.0f;
+	int i = 0;
+
+	// scalar until the data is aligned for the SIMD registers
+	for (; i < numSamples && !SIMD::isSIMDAligned(data + i); i++)
+	{
+		sum += data[i] * data[i];
+	}
+
+	auto lanes = SIMD::expand(0.0f);
+	for (; i + numLanes <= numSamples; i += numLanes)
+	{
+		auto values = SIMD::fromRawArray(data + i);
+		lanes += values * values;
+	}
+	sum += lanes.sum();
+
+	for (; i < numSamples; i++)
+	{
+		sum += data[i] * data[i];
+	}
+
+	return sum;
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    jr_OutputMeter.h
+    Created: 21 Oct 2026 2:18:45pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace jr
+{
+	/*
+	Measures the peak, RMS and short-term loudness (LUFS, ITU-R BS.1770 K-weighting over a 3 second window) of the plugin
+	output. Measuring happens on the audio thread, and the latest values are published through atomics so that any number of
+	readers on any thread can query them without locking, whether or not an editor is open.
+
+	Every output channel is weighted equally in the loudness sum, as the plugin's ring and ambisonic layouts have no standard
+	channel weights.
+	*/
+	class OutputMeter
+	{
+	public:
+		/*
+		The latest measurements, all in decibels relative to full scale
+		*/
+		struct Levels
+		{
+			float peak{ minDecibels };			// highest sample, held and then falling at peakFallDbPerSecond
+			float rms{ minDecibels };			// RMS over about the last 300ms, averaged across channels
+			float shortTermLufs{ minDecibels };	// K-weighted loudness of the last 3 seconds, updated every 100ms
+		};
+
+		static constexpr float minDecibels = -100.0f;
+
+		/*
+		Calculates the filter coefficients and allocates the filter state and scratch buffer. Call before playing, not while processing.
+		*/
+		void prepare(double sampleRate, int numChannels, int samplesPerBlock);
+
+		/*
+		Measures buffer and publishes the updated levels. Audio thread only.
+		*/
+		void process(const juce::AudioBuffer<float>& buffer);
+
+		/*
+		Returns the latest levels. Any thread.
+		*/
+		Levels getLevels() const { return { peakDb.load(), rmsDb.load(), shortTermLufs.load() }; }
+
+		/*
+		Returns the sum of the squares of numSamples samples of data, using SIMD registers where data is aligned
+		*/
+		static float sumOfSquares(const float* data, int numSamples);
+
+	private:
+		/*
+		A biquad filter in transposed direct form II, one per stage of the K-weighting filter
+		*/
+		struct Biquad
+		{
+			float b0{ 1.0f }, b1{}, b2{}, a1{}, a2{};
+		};
+
+		/*
+		Filter state for one channel of one biquad
+		*/
+		struct BiquadState
+		{
+			float z1{}, z2{};
+		};
+
+		/*
+		Filters numSamples of input into output with the given biquad, keeping state between calls
+		*/
+		static void processBiquad(const Biquad& filter, BiquadState& state, const float* input, float* output, int numSamples);
+
+		/*
+		Measures numSamples of buffer starting at startSample, which must fit in the scratch buffer
+		*/
+		void processChunk(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+		static constexpr float peakFallDbPerSecond = 20.0f;
+		static constexpr float rmsTimeSeconds = 0.3f;				// time constant of the RMS average
+		static constexpr int numLoudnessSlots = 30;					// 100ms slots in the 3 second short-term window
+
+		double sampleRate{ 44100.0 };
+		Biquad shelf, highPass;										// the two stages of the K-weighting filter
+		std::vector<BiquadState> shelfStates, highPassStates;		// one per channel
+		std::vector<float> scratch;									// K-weighted samples of one channel
+
+		float heldPeak{ 0.0f };										// linear peak, falling between blocks
+		float meanSquare{ 0.0f };									// running average used for the RMS
+		std::array<float, numLoudnessSlots> loudnessSlots{};		// K-weighted sum of squares of each 100ms slot
+		int loudnessSlotIndex{ 0 };
+		int loudnessSlotLength{ 4410 };								// samples in a 100ms slot
+		int samplesInSlot{ 0 };
+		int numFilledSlots{ 0 };									// slots measured since prepare, up to numLoudnessSlots
+
+		std::atomic<float> peakDb{ minDecibels };
+		std::atomic<float> rmsDb{ minDecibels };
+		std::atomic<float> shortTermLufs{ minDecibels };
+	};
+}
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    jr_Panner.h
+    Created: 19 Oct 2026 9:41:12am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+namespace jr
+{
+    /*
+    Converts a voice's pan value into a gain for each output channel of the current speaker layout.
+    Gains are only calculated when a voice is repositioned, so the audio loop only has to multiply by them.
+
+    Mono and stereo use the original linear pan law. Any other layout of 3 to 16 channels, discrete or named (5.1, 7.1,
+    octagonal and so on), is treated as a ring of evenly spaced speakers in channel order (channel 1 at front centre, the rest
+    following clockwise) and uses pairwise amplitude panning. The named speaker positions are not used.
+    Ambisonic layouts use a horizontal ACN/SN3D encode up to third order.
+    */
+    class Panner
+    {
+    public:
+        static constexpr int maxChannels = 16;
+        static constexpr int maxAmbisonicOrder = 3;
+
+        using Gains = std::array<float, maxChannels>;
+
+        /*
+        Returns true if the channel set is one that the panner can render to
+        */
+        static bool isLayoutSupported(const juce::AudioChannelSet& layout)
+        {
+            if (layout == juce::AudioChannelSet::mono() || layout == juce::AudioChannelSet::stereo())
+            {
+                return true;
+            }
+
+            auto order = layout.getAmbisonicOrder();
+            if (order > 0)
+            {
+                return order <= maxAmbisonicOrder;
+            }
+
+            return layout.size() >= 3 && layout.size() <= maxChannels;
+        }
+
+        /*
+        Sets the speaker layout that gains will be calculated for
+        */
+        void setLayout(const juce::AudioChannelSet& layout)
+        {
+            numChannels = juce::jlimit(1, maxChannels, layout.size());
+            ambisonicOrder = layout.getAmbisonicOrder();
+
+            if (numChannels == 1)
+            {
+                mode = Mode::mono;
+            }
+            else if (ambisonicOrder > 0)
+            {
+                mode = Mode::ambisonic;
+            }
+            else if (numChannels == 2)
+            {
+                mode = Mode::stereo;
+            }
+            else
+            {
+                mode = Mode::ring;
+            }
+        }
+
+        int getNumChannels() const { return numChannels; }
+
+        /*
+        Fills gains with the level of each output channel for a voice at the given pan value (0=L 1=R 0.5=C).
+        Channels above getNumChannels() are set to 0.
+        */
+        void getGains(float pan, Gains& gains) const
+        {
+            gains.fill(0.0f);
+
+            switch (mode)
+            {
+            case Mode::mono:
+                gains[0] = 1.0f;
+                break;
+            case Mode::stereo:
+                gains[0] = 1.0f - pan;
+                gains[1] = pan;
+                break;
+            case Mode::ring:
+                getRingGains(getAzimuth(pan), gains);
+                break;
+            case Mode::ambisonic:
+                getAmbisonicGains(getAzimuth(pan), gains);
+                break;
+            }
+        }
+
+    private:
+        enum class Mode { mono, stereo, ring, ambisonic };
+
+        /*
+        Maps a pan value to an azimuth in radians, anticlockwise from the front, so that full stereo width covers the whole circle
+        */
+        static float getAzimuth(float pan)
+        {
+            return (0.5f - pan) * juce::MathConstants<float>::twoPi;
+        }
+
+        /*
+        Constant power pairwise panning (2D VBAP) between the two ring speakers either side of the azimuth
+        */
+        void getRingGains(float azimuth, Gains& gains) const
+        {
+            auto twoPi = juce::MathConstants<float>::twoPi;
+            auto spacing = twoPi / (float)numChannels;
+
+            // clockwise angle from the first speaker, wrapped between 0 and twoPi
+            auto angle = std::fmod(-azimuth, twoPi);
+            if (angle < 0.0f)
+            {
+                angle += twoPi;
+            }
+
+            int first = (int)(angle / spacing) % numChannels;
+            int second = (first + 1) % numChannels;
+            auto theta = angle - (float)first * spacing;
+
+            auto g1 = std::sin(spacing - theta);
+            auto g2 = std::sin(theta);
+            auto norm = 1.0f / std::sqrt(g1 * g1 + g2 * g2);
+
+            gains[first] = g1 * norm;
+            gains[second] = g2 * norm;
+        }
+
+        /*
+        Horizontal only ambisonic encode in ACN channel order with SN3D normalisation
+        */
+        void getAmbisonicGains(float azimuth, Gains& gains) const
+        {
+            gains[0] = 1.0f;
+
+            if (ambisonicOrder >= 1)
+            {
+                gains[1] = std::sin(azimuth);
+                gains[3] = std::cos(azimuth);
+            }
+
+            if (ambisonicOrder >= 2)
+            {
+                const auto k = std::sqrt(3.0f) * 0.5f;
+                gains[4] = k * std::sin(2.0f * azimuth);
+                gains[6] = -0.5f;
+                gains[8] = k * std::cos(2.0f * azimuth);
+            }
+
+            if (ambisonicOrder >= 3)
+            {
+                const auto k1 = std::sqrt(3.0f / 8.0f);
+                const auto k3 = std::sqrt(5.0f / 8.0f);
+                gains[9] = k3 * std::sin(3.0f * azimuth);
+                gains[11] = -k1 * std::sin(azimuth);
+                gains[13] = -k1 * std::cos(azimuth);
+                gains[15] = k3 * std::cos(3.0f * azimuth);
+            }
+        }
+
+        Mode mode{ Mode::stereo };
+        int numChannels{ 2 };
+        int ambisonicOrder{ -1 };
+    };
+}
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    jr_PitchTable.cpp
+    Created: 25 Oct 2026 9:48:05am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_PitchTable.h"
+#include <cmath>
+
+bool jr::PitchTable::parseScala(const juce::String& text, Scale& scale, juce::String& description)
+{
+	juce::StringArray lines;
+	lines.addLines(text);
+
+	juce::String parsedDescription;
+	bool hasDescription = false;
+	int numDegrees = -1;
+	Scale parsed;
+
+	for (auto& line : lines)
+	{
+		if (line.startsWithChar('!'))
+		{
+			continue;
+		}
+
+		// the description is the first line that isn't a comment, even if it is empty
+		if (!hasDescription)
+		{
+			parsedDescription = line.trim();
+			hasDescription = true;
+			continue;
+		}
+
+		// anything after the number or pitch on a line is a comment
+		auto token = line.trim().initialSectionNotContaining(" \t");
+		if (token.isEmpty())
+		{
+			continue;
+		}
+
+		if (numDegrees < 0)
+		{
+			numDegrees = token.containsOnly("0123456789") ? token.getIntValue() : 0;
+			if (numDegrees < 1 || numDegrees > maxScaleSize)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		auto ratio = parseScalaPitch(token);
+		if (ratio <= 0.0f)
+		{
+			return false;
+		}
+
+		parsed.ratios[parsed.size++] = ratio;
+		if (parsed.size == numDegrees)
+		{
+			break;
+		}
+	}
+
+	// the last degree is the period, which has to rise for the scale to repeat
+	if (numDegrees < 1 || parsed.size != numDegrees || parsed.ratios[parsed.size - 1] <= 1.0f)
+	{
+		return false;
+	}
+
+	scale = parsed;
+	description = parsedDescription;
+	return true;
+}
+
+float jr::PitchTable::parseScalaPitch(const juce::String& pitch)
+{
+	if (pitch.containsChar('.'))
+	{
+		if (!pitch.containsOnly("0123456789.-+"))
+		{
+			return 0.0f;
+		}
+		return (float)std::pow(2.0, pitch.getDoubleValue() / 1200.0);
+	}
+
+	auto numerator = pitch.upToFirstOccurrenceOf("/", false, false);
+	auto denominator = pitch.containsChar('/') ? pitch.fromFirstOccurrenceOf("/", false, false) : juce::String("1");
+	if (!numerator.containsOnly("0123456789") || !denominator.containsOnly("0123456789"))
+	{
+		return 0.0f;
+	}
+
+	auto numeratorValue = (double)numerator.getLargeIntValue();
+	auto denominatorValue = (double)denominator.getLargeIntValue();
+	return numeratorValue > 0.0 && denominatorValue > 0.0 ? (float)(numeratorValue / denominatorValue) : 0.0f;
+}
+
+void jr::PitchTable::build(Mode _mode, float _minFreq, float _maxFreq, float rootFreq, const Scale& scale)
+{
+	mode = _mode;
+	minFreq = _minFreq;
+	maxFreq = _maxFreq;
+	logRange = minFreq > 0.0f && maxFreq > 0.0f ? std::log(maxFreq / minFreq) : 0.0f;
+	numNotes = 0;
+
+	// a just major scale, and the twelve equal steps of an octave
+	static const Scale justScale = makeScale({ 9.0f / 8.0f, 5.0f / 4.0f, 4.0f / 3.0f, 3.0f / 2.0f, 5.0f / 3.0f, 15.0f / 8.0f, 2.0f });
+	static const Scale equalScale = makeScale({ 1.0594631f, 1.1224620f, 1.1892071f, 1.2599210f, 1.3348399f, 1.4142136f,
+												1.4983071f, 1.5874011f, 1.6817928f, 1.7817974f, 1.8877486f, 2.0f });
+
+	switch (mode)
+	{
+	case Mode::harmonic:
+		for (int harmonic{ 1 }; rootFreq > 0.0f && rootFreq * (float)harmonic <= maxFreq && numNotes < maxNumNotes; harmonic++)
+		{
+			auto frequency = rootFreq * (float)harmonic;
+			if (frequency >= minFreq)
+			{
+				notes[numNotes++] = frequency;
+			}
+		}
+		break;
+
+	case Mode::justIntonation:		addScaleNotes(rootFreq, justScale); break;
+	case Mode::equalTemperament:	addScaleNotes(rootFreq, equalScale); break;
+	case Mode::scala:				addScaleNotes(rootFreq, scale.size > 0 ? scale : equalScale); break;
+
+	case Mode::linear:
+	case Mode::logarithmic:
+	default:
+		break;
+	}
+}
+
+void jr::PitchTable::addScaleNotes(float rootFreq, const Scale& scale)
+{
+	auto period = scale.size > 0 ? scale.ratios[scale.size - 1] : 0.0f;
+	if (rootFreq <= 0.0f || minFreq <= 0.0f || period <= 1.0f)
+	{
+		return;
+	}
+
+	// start from the repeat of the root at or below the bottom of the range, and work up a period at a time
+	auto base = rootFreq * std::pow(period, std::floor(std::log(minFreq / rootFreq) / std::log(period)));
+	for (; base <= maxFreq && numNotes < maxNumNotes; base *= period)
+	{
+		for (int degree{ -1 }; degree < scale.size - 1 && numNotes < maxNumNotes; degree++)
+		{
+			auto frequency = degree < 0 ? base : base * scale.ratios[degree];
+			if (frequency >= minFreq && frequency <= maxFreq)
+			{
+				notes[numNotes++] = frequency;
+			}
+		}
+	}
+}
+
+jr::PitchTable::Scale jr::PitchTable::makeScale(std::initializer_list<float> ratios)
+{
+	Scale scale;
+	for (auto ratio : ratios)
+	{
+		scale.ratios[scale.size++] = ratio;
+	}
+	return scale;
+}
+
+float jr::PitchTable::getRandomFrequency(juce::Random& random) const
+{
+	if (numNotes > 0)
+	{
+		return notes[random.nextInt(numNotes)];
+	}
+
+	if (mode == Mode::linear)
+	{
+		return minFreq + random.nextFloat() * (maxFreq - minFreq);
+	}
+
+	return minFreq * std::exp(random.nextFloat() * logRange);
+}
+
+float jr::PitchTable::getRandomContinuousFrequency(Mode mode, float minFreq, float maxFreq, juce::Random& random)
+{
+	if (mode == Mode::linear)
+	{
+		return minFreq + random.nextFloat() * (maxFreq - minFreq);
+	}
+
+	auto range = minFreq > 0.0f && maxFreq > 0.0f ? std::log(maxFreq / minFreq) : 0.0f;
+	return minFreq * std::exp(random.nextFloat() * range);
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    jr_PitchTable.h
+    Created: 25 Oct 2026 9:48:05am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+namespace jr
+{
+	/*
+	Picks random voice frequencies within a range, following one of several distributions.
+
+	Linear and logarithmic picks are spread evenly over the range in Hz or in pitch. The other modes only pick notes: the
+	harmonic series of the root, a just or equal tempered scale on the root, or a scale loaded from a Scala file. Every note
+	of those that falls in the range is worked out once by build() into a fixed size table, so picking a note is a single
+	random index into the table and nothing is allocated.
+	*/
+	class PitchTable
+	{
+	public:
+		enum class Mode { linear, logarithmic, harmonic, justIntonation, equalTemperament, scala };
+
+		static constexpr int maxScaleSize = 128;
+
+		/*
+		The degrees of a scale above its root as frequency ratios, as listed in a Scala file. The last degree is the period
+		that the scale repeats at, usually an octave.
+		*/
+		struct Scale
+		{
+			std::array<float, maxScaleSize> ratios{};
+			int size{ 0 };
+		};
+
+		/*
+		Reads the contents of a Scala (.scl) file into scale, and its description line into description. Returns false, leaving
+		scale as it was, if the text isn't a valid scale or has more than maxScaleSize degrees.
+		*/
+		static bool parseScala(const juce::String& text, Scale& scale, juce::String& description);
+
+		/*
+		Works out the frequencies to pick from for mode within minFreq and maxFreq, with harmonics and scales built up from
+		rootFreq. scale is only used by Mode::scala, and an empty scale is treated as equal temperament. Doesn't allocate.
+		*/
+		void build(Mode _mode, float _minFreq, float _maxFreq, float rootFreq, const Scale& scale);
+
+		/*
+		Returns a random frequency in Hz. If the range holds no notes of the current mode, picks as Mode::logarithmic.
+		*/
+		float getRandomFrequency(juce::Random& random) const;
+
+		/*
+		Returns true for the modes that pick anywhere in the range rather than from notes, which need no table
+		*/
+		static bool isContinuous(Mode mode) { return mode == Mode::linear || mode == Mode::logarithmic; }
+
+		/*
+		Returns a random frequency in Hz between minFreq and maxFreq, spread evenly in Hz for Mode::linear and in pitch
+		otherwise. Needs no table, so it can follow a range that is changing.
+		*/
+		static float getRandomContinuousFrequency(Mode mode, float minFreq, float maxFreq, juce::Random& random);
+
+		/*
+		Returns the number of notes that can be picked from, or 0 for the continuous modes
+		*/
+		int getNumNotes() const { return numNotes; }
+
+	private:
+		static constexpr int maxNumNotes = 2048;		// more than enough for every note of a 128 note scale over the audible range
+
+		/*
+		Adds every note of scale on rootFreq that falls within the range to the table
+		*/
+		void addScaleNotes(float rootFreq, const Scale& scale);
+
+		/*
+		Returns a scale with the given ratios, the last of which is the period
+		*/
+		static Scale makeScale(std::initializer_list<float> ratios);
+
+		/*
+		Reads a Scala pitch, either cents if it contains a full stop or a ratio such as 3/2 or 2. Returns 0 if it isn't valid.
+		*/
+		static float parseScalaPitch(const juce::String& pitch);
+
+		std::array<float, maxNumNotes> notes{};
+		int numNotes{ 0 };
+		Mode mode{ Mode::linear };
+		float minFreq{ 120.0f };
+		float maxFreq{ 1200.0f };
+		float logRange{ 0.0f };							// natural log of maxFreq / minFreq, for logarithmic picks
+	};
+}
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    jr_PresetMorph.cpp
+    Created: 23 Oct 2026 3:07:45pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_PresetMorph.h"
+#include <cmath>
+
+void jr::PresetMorph::prepare(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+	controlInterval = juce::jmax(1, (int)(controlSeconds * sampleRate));
+	active = false;
+}
+
+void jr::PresetMorph::start(const FaderPairs::Settings& from, const FaderPairs::Settings& to, double seconds)
+{
+	// from may be the current settings of a morph that is being interrupted
+	auto startSettings = from;
+
+	for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+	{
+		auto& fromLayer = startSettings.layers[(size_t)layer];
+		auto& toLayer = to.layers[(size_t)layer];
+		buildPath(getLayerPath(layer, lfoRate), fromLayer.lfoRate, toLayer.lfoRate, false);
+		buildPath(getLayerPath(layer, minFreq), fromLayer.minFreq, toLayer.minFreq, true);
+		buildPath(getLayerPath(layer, maxFreq), fromLayer.maxFreq, toLayer.maxFreq, true);
+		buildPath(getLayerPath(layer, stereoWidth), fromLayer.stereoWidth, toLayer.stereoWidth, false);
+		buildPath(getLayerPath(layer, waveShape), fromLayer.waveShape, toLayer.waveShape, false);
+		buildPath(getLayerPath(layer, numOscs), (float)fromLayer.numOscs, (float)toLayer.numOscs, false);
+	}
+	buildPath(numPartials, (float)startSettings.numPartials, (float)to.numPartials, true);
+	buildPath(rootNote, startSettings.rootNote, to.rootNote, false);
+
+	current = startSettings;
+	target = to;
+	lengthSamples = juce::jmax((juce::int64)1, (juce::int64)(seconds * sampleRate));
+	elapsedSamples = 0;
+	samplesUntilStep = 0;
+	active = true;
+}
+
+void jr::PresetMorph::process(FaderPairs& faders, int numSamples)
+{
+	if (!active)
+	{
+		return;
+	}
+
+	elapsedSamples += numSamples;
+	samplesUntilStep -= numSamples;
+	if (samplesUntilStep > 0 && elapsedSamples < lengthSamples)
+	{
+		return;
+	}
+	samplesUntilStep = juce::jmax(1, samplesUntilStep + controlInterval);
+
+	if (elapsedSamples >= lengthSamples)
+	{
+		// land exactly on the target rather than the last point of the tables
+		moveTo(faders, target);
+		active = false;
+		return;
+	}
+
+	auto progress = (float)((double)elapsedSamples / (double)lengthSamples);
+
+	FaderPairs::Settings next;
+	for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+	{
+		auto& nextLayer = next.layers[(size_t)layer];
+		nextLayer.lfoRate = getPathValue(getLayerPath(layer, lfoRate), progress);
+		nextLayer.minFreq = getPathValue(getLayerPath(layer, minFreq), progress);
+		nextLayer.maxFreq = getPathValue(getLayerPath(layer, maxFreq), progress);
+		nextLayer.stereoWidth = getPathValue(getLayerPath(layer, stereoWidth), progress);
+		nextLayer.waveShape = getPathValue(getLayerPath(layer, waveShape), progress);
+		nextLayer.numOscs = juce::roundToInt(getPathValue(getLayerPath(layer, numOscs), progress));
+	}
+	next.numPartials = juce::roundToInt(getPathValue(numPartials, progress));
+	next.rootNote = getPathValue(rootNote, progress);
+	next.engine = progress < 0.5f ? current.engine : target.engine;
+	next.pitchMode = progress < 0.5f ? current.pitchMode : target.pitchMode;
+
+	moveTo(faders, next);
+}
+
+void jr::PresetMorph::buildPath(int path, float start, float end, bool isLogarithmic)
+{
+	auto& points = paths[path];
+	isLogarithmic = isLogarithmic && start > 0.0f && end > 0.0f;
+
+	for (int i{}; i < numPathPoints; i++)
+	{
+		// smoothstep, so that the morph leaves and arrives gently
+		auto t = (float)i / (float)(numPathPoints - 1);
+		auto eased = t * t * (3.0f - 2.0f * t);
+
+		points[i] = isLogarithmic ? start * std::pow(end / start, eased) : start + (end - start) * eased;
+	}
+}
+
+float jr::PresetMorph::getPathValue(int path, float progress) const
+{
+	auto& points = paths[path];
+	auto position = juce::jlimit(0.0f, 1.0f, progress) * (float)(numPathPoints - 1);
+	auto index = juce::jmin((int)position, numPathPoints - 2);
+	auto fraction = position - (float)index;
+	return points[index] + (points[index + 1] - points[index]) * fraction;
+}
+
+void jr::PresetMorph::moveTo(FaderPairs& faders, const FaderPairs::Settings& next)
+{
+	for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+	{
+		auto& nextLayer = next.layers[(size_t)layer];
+		auto& currentLayer = current.layers[(size_t)layer];
+
+		if (nextLayer.minFreq != currentLayer.minFreq)
+		{
+			faders.setMinFreq(layer, nextLayer.minFreq);
+		}
+		if (nextLayer.maxFreq != currentLayer.maxFreq)
+		{
+			faders.setMaxFreq(layer, nextLayer.maxFreq);
+		}
+		if (nextLayer.lfoRate != currentLayer.lfoRate)
+		{
+			faders.setLfoRate(layer, nextLayer.lfoRate);
+		}
+		if (nextLayer.stereoWidth != currentLayer.stereoWidth)
+		{
+			faders.setStereoWidth(layer, nextLayer.stereoWidth);
+		}
+		if (nextLayer.waveShape != currentLayer.waveShape)
+		{
+			faders.setWaveShape(layer, nextLayer.waveShape);
+		}
+		if (nextLayer.numOscs != currentLayer.numOscs)
+		{
+			faders.setNumOscs(layer, nextLayer.numOscs);
+		}
+	}
+	if (next.numPartials != current.numPartials)
+	{
+		faders.setNumPartials(next.numPartials);
+	}
+	if (next.engine != current.engine)
+	{
+		faders.setEngine(next.engine);
+	}
+	if (next.pitchMode != current.pitchMode)
+	{
+		faders.setPitchMode(next.pitchMode);
+	}
+	if (next.rootNote != current.rootNote)
+	{
+		faders.setRootNote(next.rootNote);
+	}
+
+	current = next;
+}
@@ -0,0 +1,109 @@
+/*
+  ==============================================================================
+
+    jr_PresetMorph.h
+    Created: 23 Oct 2026 3:07:45pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include "jr_FaderPairs.h"
+
+namespace jr
+{
+	/*
+	Morphs the engine from one set of settings to another over a chosen time, for moving between drone scenes.
+
+	When a morph starts, the path of every parameter is worked out in full and stored in a fixed size table, eased in and out
+	and spaced logarithmically for frequencies. While it runs, the engine is stepped along the tables at control rate, and
+	only the settings that have changed since the last step are passed on, so a morph never allocates and the parameter
+	listeners are never involved. The voice and partial counts are rounded, so voices fade in and out one at a time as usual,
+	and the engine crossfades and the pitch mode switches half way through if they change.
+	*/
+	class PresetMorph
+	{
+	public:
+		/*
+		Settings stored to be morphed to later
+		*/
+		struct Scene
+		{
+			FaderPairs::Settings settings;
+			bool isStored{ false };
+		};
+
+		static constexpr int numScenes = 2;
+		using Scenes = std::array<Scene, numScenes>;
+
+		/*
+		Sets the control rate for the sample rate and stops any morph. Call before playing.
+		*/
+		void prepare(double _sampleRate);
+
+		/*
+		Starts morphing from the settings in from, which the engine should already have, to the settings in to over the given
+		time. Call from the thread that processes.
+		*/
+		void start(const FaderPairs::Settings& from, const FaderPairs::Settings& to, double seconds);
+
+		/*
+		Stops the morph where it is
+		*/
+		void cancel() { active = false; }
+
+		bool isActive() const { return active; }
+
+		/*
+		Returns the settings the engine was last moved to
+		*/
+		const FaderPairs::Settings& getCurrent() const { return current; }
+
+		/*
+		Advances the morph by numSamples, moving faders to the next step on its path when a control step is due.
+		Call from the thread that processes, once per block before faders is processed.
+		*/
+		void process(FaderPairs& faders, int numSamples);
+
+	private:
+		// every layer has a path for each of its settings, followed by the paths of the shared settings
+		enum LayerPath { lfoRate, minFreq, maxFreq, stereoWidth, waveShape, numOscs, numLayerPaths };
+		enum SharedPath { numPartials = numLayerPaths * FaderPairs::maxNumLayers, rootNote, numPaths };
+
+		static constexpr int numPathPoints = 129;
+		static constexpr double controlSeconds = 0.01;		// time between steps of the morph
+
+		/*
+		Returns the index of the layer's path for one of its settings
+		*/
+		static int getLayerPath(int layer, LayerPath path) { return layer * numLayerPaths + path; }
+
+		/*
+		Fills the table for path with numPathPoints eased steps between start and end, spaced logarithmically if isLogarithmic
+		*/
+		void buildPath(int path, float start, float end, bool isLogarithmic);
+
+		/*
+		Returns the value of path at progress (0 - 1) through the morph
+		*/
+		float getPathValue(int path, float progress) const;
+
+		/*
+		Passes every setting in next that differs from the current settings on to faders
+		*/
+		void moveTo(FaderPairs& faders, const FaderPairs::Settings& next);
+
+		std::array<std::array<float, numPathPoints>, numPaths> paths{};
+		FaderPairs::Settings current;
+		FaderPairs::Settings target;
+		double sampleRate{ 44100.0 };
+		int controlInterval{ 441 };							// samples between steps
+		juce::int64 lengthSamples{ 1 };
+		juce::int64 elapsedSamples{ 0 };
+		int samplesUntilStep{ 0 };
+		bool active{ false };
+	};
+}
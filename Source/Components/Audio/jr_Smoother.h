@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    jr_Smoother.h
+    Created: 24 Oct 2026 11:02:18am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+namespace jr
+{
+	/*
+	A linear smoother with the same interface as juce::SmoothedValue, for values that sit still most of the time.
+
+	isSettled() is a single comparison, so per sample code can take a constant path once the target has been reached, and
+	fillBlock() writes a whole block of values at once, as a ramp the compiler can vectorise followed by a vectorised fill.
+	*/
+	class Smoother
+	{
+	public:
+		Smoother(float initialValue = 0.0f) : current(initialValue), target(initialValue) {}
+
+		/*
+		Sets the ramp length and jumps to the target
+		*/
+		void reset(double sampleRate, double rampLengthInSeconds)
+		{
+			stepsToTarget = (int)std::floor(rampLengthInSeconds * sampleRate);
+			setCurrentAndTargetValue(target);
+		}
+
+		void setTargetValue(float newTarget)
+		{
+			if (newTarget == target)
+			{
+				return;
+			}
+
+			if (stepsToTarget <= 0)
+			{
+				setCurrentAndTargetValue(newTarget);
+				return;
+			}
+
+			target = newTarget;
+			countdown = stepsToTarget;
+			step = (target - current) / (float)countdown;
+		}
+
+		void setCurrentAndTargetValue(float newValue)
+		{
+			current = target = newValue;
+			countdown = 0;
+		}
+
+		float getCurrentValue() const noexcept { return current; }
+
+		float getTargetValue() const noexcept { return target; }
+
+		/*
+		Returns true once the target has been reached, after which every value is the target
+		*/
+		bool isSettled() const noexcept { return countdown == 0; }
+
+		float getNextValue() noexcept
+		{
+			if (countdown == 0)
+			{
+				return target;
+			}
+
+			countdown--;
+			current = countdown == 0 ? target : current + step;
+			return current;
+		}
+
+		/*
+		Moves numSamples along the ramp and returns the value reached
+		*/
+		float skip(int numSamples) noexcept
+		{
+			if (numSamples >= countdown)
+			{
+				setCurrentAndTargetValue(target);
+				return target;
+			}
+
+			current += step * (float)numSamples;
+			countdown -= numSamples;
+			return current;
+		}
+
+		/*
+		Fills dest with the next numSamples values. Returns true if they are all the target, so the caller can treat the block
+		as constant.
+		*/
+		bool fillBlock(float* dest, int numSamples) noexcept
+		{
+			if (countdown == 0)
+			{
+				juce::FloatVectorOperations::fill(dest, target, numSamples);
+				return true;
+			}
+
+			int numRamped = juce::jmin(numSamples, countdown);
+			auto start = current;
+			for (int i{}; i < numRamped; i++)
+			{
+				dest[i] = start + step * (float)(i + 1);
+			}
+
+			// the last step lands exactly on the target, however the steps have rounded
+			skip(numRamped);
+			dest[numRamped - 1] = current;
+
+			if (numRamped < numSamples)
+			{
+				juce::FloatVectorOperations::fill(dest + numRamped, target, numSamples - numRamped);
+			}
+			return false;
+		}
+
+	private:
+		float current{};
+		float target{};
+		float step{};
+		int countdown{ 0 };					// samples left until the target is reached
+		int stepsToTarget{ 0 };
+	};
+}
@@ -0,0 +1,338 @@
+/*
+  ==============================================================================
+
+    jr_SpectralEngine.cpp
+    Created: 19 Oct 2026 11:02:45am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_SpectralEngine.h"
+#include <cmath>
+
+void FaderPairs::SpectralEngine::init(float _sampleRate, int maxNumPartials, int numChannels)
+{
+	sampleRate = _sampleRate;
+
+	auto frameRate = sampleRate / (float)hopSize;
+	partialLevel.reset(frameRate, parent.rampTime);
+	fadeStep = 1.0f / juce::jmax(1.0f, parent.rampTime * frameRate);
+
+	// the window tables only depend on the frame sizes, so one copy is shared by every engine, including those rendering frozen loops
+	window = &parent.resources->getSpectralWindow(fftSize, hopSize, lobeHalfWidth, lobeResolution);
+
+	numChannels = juce::jmax(1, numChannels);
+	spectra.assign(numChannels, std::vector<float>(2 * fftSize, 0.0f));
+	overlap.setSize(numChannels, 2 * hopSize);
+	overlap.clear();
+	frameOut.setSize(numChannels, hopSize);
+	frameOut.clear();
+	readPosition = hopSize;
+	renderingMono = numChannels == 1;
+
+	if (partials.empty())
+	{
+		// first time only
+		partials.resize(maxNumPartials);
+		for (auto& partial : partials)
+		{
+			partial.lfoBaseFreq = parent.random.nextFloat();
+			resetPartial(partial);
+		}
+		setNumPartials(numActivePartials);
+		partialLevel.setCurrentAndTargetValue(partialLevel.getTargetValue());
+	}
+}
+
+void FaderPairs::SpectralEngine::setNumPartials(int numPartials)
+{
+	numPartials = juce::jmax(1, numPartials);
+
+	if (!partials.empty())
+	{
+		numPartials = juce::jmin(numPartials, (int)partials.size());
+
+		for (int i{}; i < (int)partials.size(); i++)
+		{
+			auto& partial = partials[i];
+			bool shouldPlay = i < numPartials;
+
+			if (shouldPlay && partial.fade == 0.0f && partial.fadeTarget == 0.0f)
+			{
+				// partial is fully silent so it can start again with new values
+				partial.lfoBaseFreq = parent.random.nextFloat();
+				resetPartial(partial);
+			}
+			partial.fadeTarget = shouldPlay ? 1.0f : 0.0f;
+		}
+	}
+
+	numActivePartials = numPartials;
+	updateLevel();
+}
+
+void FaderPairs::SpectralEngine::updateLevel()
+{
+	// partials are incoherent, so their combined level grows with the square root of their number. The parent's loudness
+	// model gives the gain for a single voice at full level, which is what each partial is.
+	auto singleVoiceGain = parent.loudness.getGain(1, parent.layers[0].waveShape, parent.layers[0].stereoWidth);
+	partialLevel.setTargetValue(singleVoiceGain / std::sqrt((float)juce::jmax(1, numActivePartials)));
+}
+
+void FaderPairs::SpectralEngine::process(juce::AudioBuffer<float>& output)
+{
+	int numSamples = output.getNumSamples();
+	int numChannels = juce::jmin(output.getNumChannels(), frameOut.getNumChannels());
+
+	for (int channel{ numChannels }; channel < output.getNumChannels(); channel++)
+	{
+		output.clear(channel, 0, numSamples);
+	}
+
+	int position{};
+	while (position < numSamples)
+	{
+		if (readPosition == hopSize)
+		{
+			renderFrame();
+		}
+
+		int numToCopy = juce::jmin(numSamples - position, hopSize - readPosition);
+		for (int channel{}; channel < numChannels; channel++)
+		{
+			output.copyFrom(channel, position, frameOut, channel, readPosition, numToCopy);
+		}
+
+		position += numToCopy;
+		readPosition += numToCopy;
+	}
+}
+
+void FaderPairs::SpectralEngine::updateGains()
+{
+	for (auto& partial : partials)
+	{
+		parent.panner.getGains(partial.pan, partial.gains);
+	}
+}
+
+void FaderPairs::SpectralEngine::scatterLfoPhases()
+{
+	for (auto& partial : partials)
+	{
+		partial.lfoPhase = parent.random.nextFloat();
+	}
+}
+
+void FaderPairs::SpectralEngine::transpose(float ratio)
+{
+	for (auto& partial : partials)
+	{
+		partial.frequency *= ratio;
+	}
+}
+
+void FaderPairs::SpectralEngine::buildSpectra()
+{
+	// if every partial shares the same position they can be drawn into one spectrum and spread to the outputs at the end
+	setRenderingMono(spectra.size() == 1 || (parent.layers[0].stereoWidth == 0.0f && numPannedPartials == 0));
+
+	int numChannels = renderingMono ? 1 : (int)spectra.size();
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		std::fill(spectra[channel].begin(), spectra[channel].end(), 0.0f);
+	}
+
+	const float unityGain[1]{ 1.0f };
+	const auto& table = *parent.resources;
+	auto twoPi = juce::MathConstants<float>::twoPi;
+	auto triangleLevel = 32.0f / (twoPi * twoPi); // 8 / pi^2
+	auto binsPerHz = (float)fftSize / sampleRate;
+	auto maxBin = (float)(fftSize / 2 - lobeHalfWidth - 1);
+	auto hopSeconds = (float)hopSize / sampleRate;
+	auto level = partialLevel.getNextValue();
+
+	for (auto& partial : partials)
+	{
+		partial.fade = partial.fadeTarget > partial.fade ? juce::jmin(partial.fadeTarget, partial.fade + fadeStep)
+		                                                 : juce::jmax(partial.fadeTarget, partial.fade - fadeStep);
+
+		if (partial.fade == 0.0f && partial.fadeTarget == 0.0f)
+		{
+			continue; // skip partials that have finished fading out
+		}
+
+		auto lfoVal = (table.sine(partial.lfoPhase) + 1.0f) * 0.5f;
+		auto amplitude = 0.5f * lfoVal * level * partial.fade; // half of the level goes to the negative frequency
+		auto bin = partial.frequency * binsPerHz;
+		const float* gains = renderingMono ? unityGain : partial.gains.data();
+
+		if (amplitude > 0.0f && bin < maxBin)
+		{
+			auto cosPhase = table.cosine(partial.phase);
+			auto sinPhase = table.sine(partial.phase);
+			auto sineAmount = (1.0f - partial.shape) * amplitude;
+			auto triangleAmount = partial.shape * triangleLevel * amplitude;
+
+			// sine and triangle fundamentals are a quarter cycle apart
+			addSinusoid(bin, sineAmount * sinPhase + triangleAmount * cosPhase, triangleAmount * sinPhase - sineAmount * cosPhase, gains, numChannels);
+
+			if (partial.shape > 0.001f)
+			{
+				// triangle is made of odd harmonics, falling with the square of the harmonic number
+				for (int harmonic{ 3 }; harmonic <= maxHarmonic && bin * (float)harmonic < maxBin; harmonic += 2)
+				{
+					auto harmonicAmount = triangleAmount / (float)(harmonic * harmonic);
+					auto harmonicPhase = partial.phase * (float)harmonic;
+					addSinusoid(bin * (float)harmonic, harmonicAmount * table.cosine(harmonicPhase), harmonicAmount * table.sine(harmonicPhase), gains, numChannels);
+				}
+			}
+		}
+
+		// move on to the centre of the next frame
+		partial.phase += partial.frequency * hopSeconds;
+		partial.phase -= std::floor(partial.phase);
+
+		auto lfoPhase = partial.lfoPhase + parent.getLfoFreqFromScale(0, partial.lfoBaseFreq) * hopSeconds;
+
+		// the LFO trough is three quarters of the way through its cycle, re-randomise once each time it is passed
+		if (std::floor(lfoPhase - 0.75f) != std::floor(partial.lfoPhase - 0.75f))
+		{
+			resetPartial(partial);
+		}
+		partial.lfoPhase = lfoPhase - std::floor(lfoPhase);
+	}
+}
+
+void FaderPairs::SpectralEngine::renderFrame()
+{
+	buildSpectra();
+
+	int numChannels = renderingMono ? 1 : (int)spectra.size();
+	for (int channel{}; channel < numChannels; channel++)
+	{
+		float* frame = spectra[channel].data();
+		fft.performRealOnlyInverseTransform(frame);
+
+		// only the centre half of the frame is used, where the triangles of neighbouring frames overlap
+		float* centre = frame + fftSize / 4;
+		float* accumulator = overlap.getWritePointer(channel);
+		juce::FloatVectorOperations::multiply(centre, window->synthesis.data(), 2 * hopSize);
+		juce::FloatVectorOperations::add(accumulator, centre, 2 * hopSize);
+
+		// first half is finished, move the second half along ready for the next frame
+		frameOut.copyFrom(channel, 0, accumulator, hopSize);
+		juce::FloatVectorOperations::copy(accumulator, accumulator + hopSize, hopSize);
+		juce::FloatVectorOperations::clear(accumulator + hopSize, hopSize);
+	}
+
+	if (renderingMono)
+	{
+		for (int channel{ frameOut.getNumChannels() - 1 }; channel >= 0; channel--)
+		{
+			frameOut.copyFrom(channel, 0, frameOut.getReadPointer(0), hopSize, parent.centreGains[channel]);
+		}
+	}
+
+	readPosition = 0;
+}
+
+void FaderPairs::SpectralEngine::addSinusoid(float bin, float re, float im, const float* gains, int numChannels)
+{
+	int firstBin = (int)std::ceil(bin - (float)lobeHalfWidth);
+	int lastBin = (int)std::floor(bin + (float)lobeHalfWidth);
+
+	for (int b{ firstBin }; b <= lastBin; b++)
+	{
+		// alternating sign moves the window from the start of the frame to its centre
+		auto lobe = getLobe((float)b - bin) * ((b & 1) ? -1.0f : 1.0f);
+		auto binRe = re * lobe;
+		auto binIm = im * lobe;
+		int index = b;
+
+		if (b < 0)
+		{
+			// lobe crosses DC, the negative frequency part folds back as its conjugate
+			index = -b;
+			binIm = -binIm;
+		}
+		else if (b == 0)
+		{
+			binRe *= 2.0f;
+			binIm = 0.0f;
+		}
+
+		for (int channel{}; channel < numChannels; channel++)
+		{
+			if (gains[channel] != 0.0f)
+			{
+				float* spectrum = spectra[channel].data();
+				spectrum[2 * index] += binRe * gains[channel];
+				spectrum[2 * index + 1] += binIm * gains[channel];
+			}
+		}
+	}
+}
+
+float FaderPairs::SpectralEngine::getLobe(float distance) const
+{
+	auto position = (distance + (float)lobeHalfWidth) * (float)lobeResolution;
+	int index = (int)position;
+
+	const auto& lobe = window->lobe;
+
+	if (position < 0.0f || index >= (int)lobe.size() - 1)
+	{
+		return 0.0f;
+	}
+
+	auto fraction = position - (float)index;
+	return lobe[index] + (lobe[index + 1] - lobe[index]) * fraction;
+}
+
+void FaderPairs::SpectralEngine::resetPartial(Partial& partial)
+{
+	partial.frequency = parent.getRandomOscFrequency(0);
+	partial.shape = parent.layers[0].waveShape;
+	resetPan(partial);
+}
+
+void FaderPairs::SpectralEngine::resetPan(Partial& partial)
+{
+	bool wasCentred = partial.pan == 0.5f;
+
+	partial.pan = 0.5f + (parent.random.nextFloat() - 0.5f) * parent.layers[0].stereoWidth;
+
+	bool isCentred = partial.pan == 0.5f;
+	if (wasCentred != isCentred)
+	{
+		numPannedPartials += isCentred ? -1 : 1;
+	}
+
+	parent.panner.getGains(partial.pan, partial.gains);
+}
+
+void FaderPairs::SpectralEngine::setRenderingMono(bool shouldRenderMono)
+{
+	if (shouldRenderMono == renderingMono || overlap.getNumChannels() == 1)
+	{
+		return;
+	}
+
+	renderingMono = shouldRenderMono;
+	int numSamples = overlap.getNumSamples();
+
+	if (renderingMono)
+	{
+		// the mono accumulator holds the unpanned sum, which channel 1 holds scaled by its centre gain
+		overlap.applyGain(0, 0, numSamples, 1.0f / parent.centreGains[0]);
+	}
+	else
+	{
+		for (int channel{ overlap.getNumChannels() - 1 }; channel >= 0; channel--)
+		{
+			overlap.copyFrom(channel, 0, overlap.getReadPointer(0), numSamples, parent.centreGains[channel]);
+		}
+	}
+}
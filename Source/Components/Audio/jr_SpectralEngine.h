@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    jr_SpectralEngine.h
+    Created: 19 Oct 2026 11:02:45am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+#include "jr_FaderPairs.h"
+#include "jr_Panner.h"
+
+/*
+An alternative to the RandomOsc voices for very large voice counts. Each partial follows the same random LFO model
+(level, frequency, pan and shape re-randomised at the bottom of each LFO cycle), but instead of running an oscillator
+per sample, every partial is drawn into a spectrum once per hop and the spectra are turned into audio with an inverse FFT
+and overlap-add. Triangle shapes are drawn as their odd harmonics.
+
+The cost of the inverse FFT does not depend on the number of partials, and each partial only costs a few bins per hop
+rather than an oscillator per sample, so several thousand partials can run on one core.
+
+Nested in FaderPairs so that it can share the first layer's frequency range, LFO rate, stereo width and wave shape, and the
+panner.
+*/
+class FaderPairs::SpectralEngine
+{
+public:
+	SpectralEngine(FaderPairs& _parent) : parent(_parent) {}
+
+	/*
+	Allocates the partials and FFT buffers. numChannels is the number of output channels that will be rendered.
+	*/
+	void init(float _sampleRate, int maxNumPartials, int numChannels);
+
+	/*
+	Sets the number of partials that should be playing, fading partials in or out as needed
+	*/
+	void setNumPartials(int numPartials);
+
+	/*
+	Replaces the contents of output with the next block of samples
+	*/
+	void process(juce::AudioBuffer<float>& output);
+
+	/*
+	Recalculates the gains of every partial. Use after the output layout has changed.
+	*/
+	void updateGains();
+
+	/*
+	Moves every partial's LFO to a random point in its cycle
+	*/
+	void scatterLfoPhases();
+
+	/*
+	Multiplies the frequency of every partial by ratio, from the next hop
+	*/
+	void transpose(float ratio);
+
+	/*
+	Sets the level of each partial from the parent's loudness model, so that the engine is as loud as the oscs would be with
+	the same settings. Use after the number of partials, wave shape or stereo width has changed.
+	*/
+	void updateLevel();
+
+private:
+	struct Partial
+	{
+		float frequency{};						// frequency of the fundamental in Hz
+		float phase{};							// phase of the fundamental at the centre of the next frame, 0-1
+		float lfoBaseFreq{};					// scale value between 0-1 used to set the LFO rate within the current range
+		float lfoPhase{};						// LFO phase at the centre of the next frame, 0-1
+		float pan{ 0.5f };						// pan value for partial, 0=L 1=R 0.5=C
+		float shape{};							// 0=Sine 1=Triangle
+		float fade{};							// current fade in/out level
+		float fadeTarget{};						// level the fade is moving towards, 0 or 1
+		jr::Panner::Gains gains{};				// gain for each output channel, calculated from pan whenever it changes
+	};
+
+	/*
+	Advances the random LFO model of every partial by one hop and draws the audible partials into the spectra
+	*/
+	void buildSpectra();
+
+	/*
+	Turns the spectra into the next hop of output samples using an inverse FFT and overlap-add
+	*/
+	void renderFrame();
+
+	/*
+	Adds the window lobe of a sinusoid at the given (fractional) bin with complex amplitude re + i*im to each channel's spectrum
+	*/
+	void addSinusoid(float bin, float re, float im, const float* gains, int numChannels);
+
+	/*
+	Returns the value of the window's spectrum at the given distance in bins from its centre
+	*/
+	float getLobe(float distance) const;
+
+	/*
+	Gives a partial a new frequency, pan and shape, as happens at the bottom of each LFO cycle
+	*/
+	void resetPartial(Partial& partial);
+
+	void resetPan(Partial& partial);
+
+	/*
+	Converts the overlap-add buffers when switching between rendering in mono and rendering every channel,
+	so that the tail of the previous frame carries on in the new mode
+	*/
+	void setRenderingMono(bool shouldRenderMono);
+
+	static constexpr int fftOrder = 10;
+	static constexpr int fftSize = 1 << fftOrder;
+	static constexpr int hopSize = fftSize / 4;
+	static constexpr int lobeHalfWidth = 4;					// main lobe of the Blackman-Harris window is +/- 4 bins wide
+	static constexpr int lobeResolution = 64;				// table points per bin
+	static constexpr int maxHarmonic = 15;					// highest triangle harmonic drawn
+
+	FaderPairs& parent;
+	std::vector<Partial> partials;
+	int numActivePartials{ 0 };
+	int numPannedPartials{ 0 };								// number of partials that are not currently panned to centre
+	float sampleRate{ 44100.0f };
+	juce::SmoothedValue<float> partialLevel{ 0.0f };		// level of a single partial at the top of its LFO, stepped once per frame
+	float fadeStep{ 1.0f };									// fade change per frame
+
+	juce::dsp::FFT fft{ fftOrder };
+	const jr::SharedResources::SpectralWindow* window{ nullptr };	// analysis lobe and synthesis window, shared by every engine
+	std::vector<std::vector<float>> spectra;				// one interleaved complex spectrum per channel, 2 * fftSize floats each
+	juce::AudioBuffer<float> overlap;						// overlap-add accumulators, 2 * hopSize samples per channel
+	juce::AudioBuffer<float> frameOut;						// finished samples from the last frame, hopSize per channel
+	int readPosition{ hopSize };							// next sample to read from frameOut
+	bool renderingMono{ false };							// true if partials are drawn into a single spectrum and spread using the centre gains
+};
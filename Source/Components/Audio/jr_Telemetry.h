@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    jr_Telemetry.h
+    Created: 20 Oct 2026 9:12:40am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace jr
+{
+    /*
+    What the GUI needs to know about a single voice to draw it
+    */
+    struct VoiceTelemetry
+    {
+        float frequency{};              // osc frequency in Hz
+        float level{};                  // RMS level since the last frame, normalised between 0 and 1
+        float peak{};                   // peak level since the last frame, normalised between 0 and 1
+        float pan{ 0.5f };              // 0=L 1=R 0.5=C
+        float waveShape{};              // 0=Sine 1=Triangle
+        bool active{ false };           // false if the voice is silenced
+    };
+
+    /*
+    A snapshot of the audio engine, published by the audio thread at a fixed interval for the GUI to draw from. Levels are
+    measured over the whole interval rather than sampled at the moment the frame is written, so motion doesn't alias against
+    the GUI frame rate.
+    */
+    struct TelemetryFrame
+    {
+        static constexpr int maxVoices = 400;      // room for every voice of every layer
+
+        std::array<VoiceTelemetry, maxVoices> voices{};
+        int numVoices{};                // number of entries in voices that are filled in
+        int numActiveVoices{};          // number of voices that are not silenced
+        uint32_t sequence{};            // increases by one with every published frame
+
+        /*
+        Returns true if every voice in other would be drawn the same as in this frame
+        */
+        bool hasSameVoices(const TelemetryFrame& other) const
+        {
+            if (numVoices != other.numVoices || numActiveVoices != other.numActiveVoices)
+            {
+                return false;
+            }
+
+            for (int i{}; i < numVoices; i++)
+            {
+                const auto& a = voices[i];
+                const auto& b = other.voices[i];
+                if (a.active != b.active || a.frequency != b.frequency || a.level != b.level || a.peak != b.peak || a.pan != b.pan || a.waveShape != b.waveShape)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /*
+    Passes TelemetryFrames from one writer thread to one reader thread without locking or allocating, using three frames:
+    the writer fills one, the reader reads another, and the third holds the most recently published frame until one of
+    them swaps it out. The reader always gets the latest complete frame and the writer never waits.
+    */
+    class TelemetryBuffer
+    {
+    public:
+        /*
+        Returns the frame to fill in before calling publish(). Writer thread only.
+        */
+        TelemetryFrame& getWriteFrame() { return frames[writeIndex]; }
+
+        /*
+        Makes the frame returned by getWriteFrame() available to the reader. Writer thread only.
+        */
+        void publish()
+        {
+            auto sequence = latestSequence.load(std::memory_order_relaxed) + 1;
+            frames[writeIndex].sequence = sequence;
+            writeIndex = latest.exchange(writeIndex | newFrameFlag) & indexMask;
+            latestSequence.store(sequence);
+        }
+
+        /*
+        Returns the sequence number of the most recently published frame, so that readers can tell if anything new has
+        been published without taking the frame. Any thread.
+        */
+        uint32_t getLatestSequence() const { return latestSequence.load(); }
+
+        /*
+        Returns the most recently published frame. The reference stays valid until the next call. Reader thread only.
+        */
+        const TelemetryFrame& read()
+        {
+            if (latest.load() & newFrameFlag)
+            {
+                readIndex = latest.exchange(readIndex) & indexMask;
+            }
+            return frames[readIndex];
+        }
+
+    private:
+        static constexpr int indexMask = 3;
+        static constexpr int newFrameFlag = 4;
+
+        std::array<TelemetryFrame, 3> frames{};
+        int writeIndex{ 0 };
+        int readIndex{ 1 };
+        std::atomic<int> latest{ 2 };   // index of the most recently published frame, with newFrameFlag set if the reader has not taken it
+        std::atomic<uint32_t> latestSequence{ 0 };
+    };
+}
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    jr_VoiceFade.h
+    Created: 24 Oct 2026 2:36:40pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+
+namespace jr
+{
+	/*
+	Fades a voice in and out along a choice of curves.
+
+	The fade is tracked as a position between 0 (silent) and 1 (fully on) that moves linearly, and the gain is the curve's
+	value at that position, so a fade that is reversed part way carries on smoothly from where it was. Gains are written a
+	block at a time in closed form: the curve is evaluated once at the start of the block, then stepped with a single
+	multiply-add (or a rotation for the trigonometric curves) per sample. Once a fade is finished the gain is constant and
+	no per sample work is needed. getSamplesUntilEnd() tells the caller exactly when the fade will finish, so whatever should
+	happen at the end can be scheduled rather than checked for every sample.
+	*/
+	class VoiceFade
+	{
+	public:
+		enum class Curve { linear, exponential, equalPower, raisedCosine };
+
+		/*
+		Sets the time a full fade takes and jumps to the end of any fade in progress
+		*/
+		void reset(double sampleRate, double fadeSeconds)
+		{
+			fadeLength = juce::jmax(1, (int)std::round(fadeSeconds * sampleRate));
+			if (isFading())
+			{
+				setImmediately(direction > 0);
+			}
+		}
+
+		/*
+		Jumps straight to fully on or silent
+		*/
+		void setImmediately(bool isOn)
+		{
+			position = isOn ? 1.0f : 0.0f;
+			direction = 0;
+			samplesRemaining = 0;
+		}
+
+		/*
+		Starts fading in from wherever the fade is now. A fade that is reversed part way keeps the curve it had.
+		*/
+		void fadeIn(Curve _curve) { startFade(1, _curve); }
+
+		/*
+		Starts fading out from wherever the fade is now. A fade that is reversed part way keeps the curve it had.
+		*/
+		void fadeOut(Curve _curve) { startFade(-1, _curve); }
+
+		bool isFading() const noexcept { return direction != 0; }
+
+		/*
+		Returns true if the fade has finished at silence
+		*/
+		bool isSilent() const noexcept { return direction == 0 && position == 0.0f; }
+
+		/*
+		Returns the number of samples until the current fade finishes, or 0 if there isn't one
+		*/
+		int getSamplesUntilEnd() const noexcept { return samplesRemaining; }
+
+		float getCurrentGain() const { return getGain(position); }
+
+		/*
+		Fills dest with the gain for each of the next numSamples samples. Returns true if they are all the same.
+		*/
+		bool fillBlock(float* dest, int numSamples)
+		{
+			if (!isFading())
+			{
+				juce::FloatVectorOperations::fill(dest, getCurrentGain(), numSamples);
+				return true;
+			}
+
+			int numFaded = juce::jmin(numSamples, samplesRemaining);
+			auto slope = (float)direction / (float)fadeLength;
+
+			switch (curve)
+			{
+			case Curve::linear:
+				for (int i{}; i < numFaded; i++)
+				{
+					dest[i] = position + slope * (float)(i + 1);
+				}
+				break;
+
+			case Curve::exponential:
+			{
+				// e^(kp) grows by the same factor every sample
+				auto growth = std::exp(exponentialSteepness * slope);
+				auto term = std::exp(exponentialSteepness * position);
+				for (int i{}; i < numFaded; i++)
+				{
+					term *= growth;
+					dest[i] = (term - 1.0f) * exponentialScale;
+				}
+				break;
+			}
+
+			case Curve::equalPower:
+			case Curve::raisedCosine:
+			{
+				// sin and cos of an angle that moves on by the same amount every sample, as a rotation
+				auto angleScale = curve == Curve::equalPower ? juce::MathConstants<float>::halfPi : halfTurn;
+				auto angle = angleScale * position;
+				auto angleStep = angleScale * slope;
+				float c = std::cos(angle), s = std::sin(angle);
+				float stepCos = std::cos(angleStep), stepSin = std::sin(angleStep);
+				bool isEqualPower = curve == Curve::equalPower;
+
+				for (int i{}; i < numFaded; i++)
+				{
+					auto nextC = c * stepCos - s * stepSin;
+					s = s * stepCos + c * stepSin;
+					c = nextC;
+					dest[i] = isEqualPower ? s : 0.5f - 0.5f * c;
+				}
+				break;
+			}
+			}
+
+			samplesRemaining -= numFaded;
+			position += slope * (float)numFaded;
+			if (samplesRemaining == 0)
+			{
+				setImmediately(direction > 0);
+			}
+
+			// don't let rounding in the stepping leave the end of the fade short of its target
+			dest[numFaded - 1] = getCurrentGain();
+
+			if (numFaded < numSamples)
+			{
+				juce::FloatVectorOperations::fill(dest + numFaded, getCurrentGain(), numSamples - numFaded);
+			}
+			return false;
+		}
+
+	private:
+		static constexpr float exponentialSteepness = 5.0f;						// the exponential curve rises by about 43dB over the fade
+		static constexpr float exponentialScale = 1.0f / (148.41316f - 1.0f);	// 1 / (e^steepness - 1), so the curve ends at 1
+		static constexpr float halfTurn = juce::MathConstants<float>::twoPi * 0.5f;
+
+		void startFade(int newDirection, Curve _curve)
+		{
+			// changing curve part way would make the gain jump from one curve's value at this position to the other's
+			if (position == 0.0f || position == 1.0f)
+			{
+				curve = _curve;
+			}
+
+			auto distance = newDirection > 0 ? 1.0f - position : position;
+			samplesRemaining = (int)std::ceil(distance * (float)fadeLength);
+			direction = samplesRemaining > 0 ? newDirection : 0;
+		}
+
+		float getGain(float _position) const
+		{
+			switch (curve)
+			{
+			case Curve::exponential:	return (std::exp(exponentialSteepness * _position) - 1.0f) * exponentialScale;
+			case Curve::equalPower:		return std::sin(juce::MathConstants<float>::halfPi * _position);
+			case Curve::raisedCosine:	return 0.5f - 0.5f * std::cos(halfTurn * _position);
+			case Curve::linear:
+			default:					return _position;
+			}
+		}
+
+		Curve curve{ Curve::raisedCosine };
+		float position{ 0.0f };				// 0 = silent, 1 = fully on
+		int direction{ 0 };					// 1 while fading in, -1 while fading out, 0 when finished
+		int samplesRemaining{ 0 };
+		int fadeLength{ 1 };				// samples a fade from silent to fully on takes
+	};
+}
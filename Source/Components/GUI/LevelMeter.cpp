@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+    Created: 21 Oct 2026 2:52:06pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+
+jr::LevelMeter::LevelMeter(jr::CustomLookAndFeel& _lookAndFeel, const jr::OutputMeter& _meter)
+    : lookAndFeel(_lookAndFeel), meter(_meter), vBlankAttachment(this, [this] { onVBlank(); })
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void jr::LevelMeter::onVBlank()
+{
+    auto latest = meter.getLevels();
+
+    bool hasChanged = std::abs(latest.peak - levels.peak) > changeThresholdDb
+        || std::abs(latest.rms - levels.rms) > changeThresholdDb
+        || std::abs(latest.shortTermLufs - levels.shortTermLufs) > changeThresholdDb;
+
+    if (hasChanged)
+    {
+        levels = latest;
+        repaint();
+    }
+}
+
+float jr::LevelMeter::getProportion(float decibels)
+{
+    return juce::jlimit(0.0f, 1.0f, (decibels - minDisplayDecibels) / -minDisplayDecibels);
+}
+
+void jr::LevelMeter::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    auto textArea = bounds.removeFromRight(bounds.getWidth() * 0.35f);
+    auto bar = bounds.reduced(2.0f, bounds.getHeight() * 0.3f);
+    auto cornerSize = bar.getHeight() * 0.5f;
+
+    g.setColour(lookAndFeel.getSliderBackgroundColour().withAlpha(0.2f));
+    g.fillRoundedRectangle(bar, cornerSize);
+
+    g.setColour(lookAndFeel.getValueTrackColour(false));
+    g.fillRoundedRectangle(bar.withWidth(bar.getWidth() * getProportion(levels.rms)), cornerSize);
+
+    auto peakX = bar.getX() + bar.getWidth() * getProportion(levels.peak);
+    g.setColour(lookAndFeel.getTextColour());
+    g.drawLine(peakX, bar.getY(), peakX, bar.getBottom(), 1.5f);
+
+    auto lufsText = levels.shortTermLufs <= jr::OutputMeter::minDecibels ? juce::String("-inf LUFS")
+                                                                          : juce::String(levels.shortTermLufs, 1) + " LUFS";
+    g.setFont(textArea.getHeight() * 0.6f);
+    g.drawFittedText(lufsText, textArea.toNearestInt(), juce::Justification::centredLeft, 1);
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+    Created: 21 Oct 2026 2:52:06pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "../Audio/jr_OutputMeter.h"
+#include "../../LookAndFeel/StyleSheet.h"
+
+namespace jr
+{
+    /*
+    A horizontal meter showing the RMS level as a bar, the peak level as a line and the short-term loudness as text, read from
+    the processor's OutputMeter. Levels are checked at every vertical blank but only repainted when they have visibly changed.
+    */
+    class LevelMeter : public juce::Component
+    {
+    public:
+        LevelMeter(jr::CustomLookAndFeel& _lookAndFeel, const jr::OutputMeter& _meter);
+
+        void paint(juce::Graphics&) override;
+
+    private:
+        /*
+        Reads the latest levels and repaints if any of them have changed by more than the meter can show
+        */
+        void onVBlank();
+
+        /*
+        Returns the proportion of the bar width that the given level in decibels fills
+        */
+        static float getProportion(float decibels);
+
+        static constexpr float minDisplayDecibels = -60.0f;     // level at the left of the bar
+        static constexpr float changeThresholdDb = 0.1f;        // smallest change that is repainted
+
+        jr::CustomLookAndFeel& lookAndFeel;
+        const jr::OutputMeter& meter;
+        jr::OutputMeter::Levels levels;                          // the levels currently drawn
+
+        juce::VBlankAttachment vBlankAttachment;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeter);
+    };
+}
@@ -28,6 +28,8 @@ namespace jr
             paramAttachment.sendInitialUpdate();
         }
 
+        ~MirrorSliderAttachment() override { slider.removeListener(this); }
+
         void sliderValueChanged(juce::Slider* _slider) override;
 
         void sliderDragStarted(juce::Slider* s) override { paramAttachment.beginGesture(); };
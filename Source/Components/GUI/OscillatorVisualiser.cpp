@@ -12,42 +12,219 @@
 #include "../../Utils/jr_utils.h"
 #include "../../Utils/jr_juce_utils.h"
 
+jr::OscillatorVisualiser::OscillatorVisualiser(jr::CustomLookAndFeel& _lookAndFeel, jr::TelemetryBuffer& _telemetry)
+    : juce::Thread("Visualiser render"), lookAndFeel(_lookAndFeel), telemetry(_telemetry),
+    vBlankAttachment(this, [this] { onVBlank(); })
+{
+    lookAndFeelChanged();
+    startThread(juce::Thread::Priority::low);
+}
+
+jr::OscillatorVisualiser::~OscillatorVisualiser()
+{
+    stopThread(1000);
+}
+
 void jr::OscillatorVisualiser::resized()
 {
-    // update size based on bounds
-    float visualiserSize = juce::jmin(getBounds().getHeight(), getBounds().getWidth());
-    maxDotSize = visualiserSize * 0.08f;
-    maxRadius = visualiserSize * 0.01f;
-    minRadius = visualiserSize * 0.0005f;
+    componentWidth = getWidth();
+    componentHeight = getHeight();
+    requestFrame();
+}
 
-    relativeCentre = getLocalBounds().getCentre().toFloat();
+void jr::OscillatorVisualiser::lookAndFeelChanged()
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(colourLock);
+        for (int bucket{}; bucket < numColourBuckets; bucket++)
+        {
+            bucketColours[bucket] = lookAndFeel.getVisualiserColour(((float)bucket + 0.5f) / (float)numColourBuckets);
+        }
+    }
+    spritesNeedUpdating = true;
+    requestFrame();
 }
 
 void jr::OscillatorVisualiser::paint(juce::Graphics& g)
 {
-    bool direction = true;
-    int pointIndex = 0;
-    for (int i{}; i < oscs.get()->size(); i++)
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (displayScale.exchange(scale) != scale)
     {
-        FaderPairs::RandomOsc& osc = oscs.get()->at(i);
-        if (osc.getIsSilenced())
+        requestFrame();
+    }
+
+    const juce::SpinLock::ScopedLockType lock(imageLock);
+    if (frontImage.isValid())
+    {
+        g.setOpacity(1.0f);
+        g.drawImage(frontImage, getLocalBounds().toFloat());
+    }
+}
+
+void jr::OscillatorVisualiser::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+        if (threadShouldExit())
         {
-            continue; // skip if voice isn't playing
+            return;
         }
-        
-        auto p = getCircumferencePoint(pointIndex);
 
-        drawDotForOsc(g, osc, direction, p);
+        renderFrame();
+        workerBusy = false;
+    }
+}
+
+void jr::OscillatorVisualiser::onVBlank()
+{
+    juce::RectangleList<int> areas;
+    {
+        const juce::SpinLock::ScopedLockType lock(imageLock);
+        areas.swapWith(dirtyAreas);
+    }
+
+    for (const auto& area : areas)
+    {
+        repaint(area);
+    }
+
+    // nothing new is published while the host isn't processing, so this stops asking for frames by itself
+    auto sequence = telemetry.getLatestSequence();
+    if (sequence != requestedSequence && isVisibleOnScreen() && !workerBusy.load())
+    {
+        requestedSequence = sequence;
+        requestFrame();
+    }
+}
+
+bool jr::OscillatorVisualiser::isVisibleOnScreen()
+{
+    if (!isShowing())
+    {
+        return false;
+    }
+
+    auto* peer = getPeer();
+    return peer != nullptr && !peer->isMinimised();
+}
+
+void jr::OscillatorVisualiser::requestFrame()
+{
+    workerBusy = true;
+    notify();
+}
+
+void jr::OscillatorVisualiser::renderFrame()
+{
+    int width = componentWidth.load();
+    int height = componentHeight.load();
+    auto scale = displayScale.load();
+
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    bool redrawAll = false;
+
+    if (width != layoutWidth || height != layoutHeight)
+    {
+        updateLayout(width, height);
+        spritesNeedUpdating = true;
+    }
+
+    if (spritesNeedUpdating.exchange(false) || scale != spriteScale)
+    {
+        updateSprites(scale);
+        redrawAll = true;
+    }
+
+    const auto& frame = telemetry.read();
+
+    // the engine is idle (frozen, silent or between parameter changes), so leave the last frame up rather than re-jittering it
+    if (!redrawAll && frame.hasSameVoices(lastFrame))
+    {
+        return;
+    }
 
-        direction = !direction; // alternate direction
-        
-        if (i % 2 > 0)
+    lastFrame = frame;
+    numActivePairs = frame.numActiveVoices;
+
+    int pixelWidth = juce::roundToInt((float)width * scale);
+    int pixelHeight = juce::roundToInt((float)height * scale);
+    if (backImage.getWidth() != pixelWidth || backImage.getHeight() != pixelHeight)
+    {
+        // software image so that it can be drawn on this thread
+        backImage = juce::Image(juce::Image::ARGB, pixelWidth, pixelHeight, true, juce::SoftwareImageType());
+    }
+    else
+    {
+        backImage.clear(backImage.getBounds());
+    }
+
+    juce::RectangleList<int> areas;
+    {
+        juce::Graphics g{ backImage };
+        g.addTransform(juce::AffineTransform::scale(scale));
+
+        bool direction = true;
+        int pointIndex = 0;
+        for (int i{}; i < frame.numVoices; i++)
+        {
+            const auto& voice = frame.voices[i];
+            if (!voice.active)
+            {
+                continue; // skip if voice isn't playing
+            }
+
+            auto p = getCircumferencePoint(pointIndex);
+
+            areas.addWithoutMerging(drawDotForVoice(g, voice, direction, p).getSmallestIntegerContainer());
+
+            direction = !direction; // alternate direction
+
+            if (i % 2 > 0)
+            {
+                pointIndex++;
+            }
+        }
+    }
+
+    // the dots of the last frame need clearing as well as the new ones drawing
+    juce::RectangleList<int> changedAreas{ areas };
+    changedAreas.add(lastAreas);
+    lastAreas.swapWith(areas);
+
+    {
+        const juce::SpinLock::ScopedLockType lock(imageLock);
+        std::swap(frontImage, backImage);
+
+        if (redrawAll)
+        {
+            dirtyAreas = juce::Rectangle<int>(width, height);
+        }
+        else
         {
-            pointIndex++;
+            dirtyAreas.add(changedAreas);
         }
     }
 }
 
+void jr::OscillatorVisualiser::updateLayout(int width, int height)
+{
+    layoutWidth = width;
+    layoutHeight = height;
+
+    // update size based on bounds
+    float visualiserSize = (float)juce::jmin(width, height);
+    maxDotSize = visualiserSize * 0.08f;
+    maxRadius = visualiserSize * 0.01f;
+    minRadius = visualiserSize * 0.0005f;
+
+    relativeCentre = juce::Rectangle<int>(width, height).getCentre().toFloat();
+}
+
 juce::Point<float> jr::OscillatorVisualiser::getCircumferencePoint(int i)
 {
     // circle array is only half points on a circle to save space, so each time the index exceeds a multiple of the array size,
@@ -68,21 +245,89 @@ juce::Point<float> jr::OscillatorVisualiser::getCircumferencePoint(int i)
     return circlePoints.at(index);
 }
 
-juce::Colour jr::OscillatorVisualiser::getColourFromOsc(FaderPairs::RandomOsc& osc)
+int jr::OscillatorVisualiser::getColourBucket(const VoiceTelemetry& voice)
 {
-    auto oscNormalisedFreq = (osc.getOscFrequency() - minFreq) / maxFreq;
-    return lookAndFeel.getVisualiserColour(oscNormalisedFreq);
+    auto normalisedFreq = jr::Utils::constrainFloat((voice.frequency - minFreq) / maxFreq);
+    return juce::jmin(numColourBuckets - 1, (int)(normalisedFreq * (float)numColourBuckets));
 }
 
-float jr::OscillatorVisualiser::getDotSizeFromOsc(FaderPairs::RandomOsc& osc)
+int jr::OscillatorVisualiser::getSizeClass(float size)
 {
-    auto size = maxDotSize * osc.getNormalisedOscLevel();
+    // class i is drawn at (i + 1) / numSizeClasses of the max dot size
+    auto sizeClass = juce::roundToInt(size / maxDotSize * (float)numSizeClasses) - 1;
+    return juce::jmin(sizeClass, numSizeClasses - 1);
+}
+
+void jr::OscillatorVisualiser::updateSprites(float scale)
+{
+    spriteScale = scale;
+
+    std::array<juce::Colour, numColourBuckets> colours;
+    {
+        const juce::SpinLock::ScopedLockType lock(colourLock);
+        colours = bucketColours;
+    }
+
+    dotSprites.clear();
+    spikeSprites.clear();
+    dotSprites.reserve(numColourBuckets * numSizeClasses);
+    spikeSprites.reserve(numColourBuckets * numSizeClasses * numSpikeRotations);
+
+    auto thirdTwoPi = juce::MathConstants<float>::twoPi / 3.0f;
+
+    for (int bucket{}; bucket < numColourBuckets; bucket++)
+    {
+        for (int sizeClass{}; sizeClass < numSizeClasses; sizeClass++)
+        {
+            auto size = maxDotSize * (float)(sizeClass + 1) / (float)numSizeClasses;
+            dotSprites.push_back(createDotSprite(size, colours[bucket], scale));
+
+            for (int rotation{}; rotation < numSpikeRotations; rotation++)
+            {
+                spikeSprites.push_back(createSpikeSprite(size, thirdTwoPi * (float)rotation / (float)numSpikeRotations, colours[bucket], scale));
+            }
+        }
+    }
+}
+
+juce::Image jr::OscillatorVisualiser::createDotSprite(float diameter, juce::Colour colour, float scale)
+{
+    // one pixel of padding on each side for the antialiased edge
+    int pixels = (int)std::ceil(diameter * scale) + 2;
+    juce::Image sprite{ juce::Image::ARGB, pixels, pixels, true, juce::SoftwareImageType() };
+    juce::Graphics g{ sprite };
+
+    g.setColour(colour);
+    g.fillEllipse(juce::Rectangle<float>(diameter * scale, diameter * scale).withCentre({ (float)pixels * 0.5f, (float)pixels * 0.5f }));
+    return sprite;
+}
+
+juce::Image jr::OscillatorVisualiser::createSpikeSprite(float r, float offset, juce::Colour colour, float scale)
+{
+    int pixels = (int)std::ceil(2.0f * r * scale) + 2;
+    juce::Image sprite{ juce::Image::ARGB, pixels, pixels, true, juce::SoftwareImageType() };
+    juce::Graphics g{ sprite };
+
+    g.setColour(colour);
+    drawTriangle(g, r * scale, { (float)pixels * 0.5f, (float)pixels * 0.5f }, offset);
+    return sprite;
+}
+
+void jr::OscillatorVisualiser::drawSprite(juce::Graphics& g, const juce::Image& sprite, const juce::Point<float>& c)
+{
+    auto size = (float)sprite.getWidth() / spriteScale;
+    g.drawImage(sprite, juce::Rectangle<float>(size, size).withCentre(c));
+}
+
+float jr::OscillatorVisualiser::getDotSizeFromVoice(const VoiceTelemetry& voice)
+{
+    auto size = maxDotSize * voice.level;
     return jr::Utils::constrainFloat(size, 0.0f, maxDotSize);
 }
 
-const juce::Point<float> jr::OscillatorVisualiser::getPointFromOsc(FaderPairs::RandomOsc& osc, bool direction, const juce::Point<float>& circumferencePoint)
+const juce::Point<float> jr::OscillatorVisualiser::getPointFromVoice(const VoiceTelemetry& voice, bool direction, const juce::Point<float>& circumferencePoint)
 {
-    float radius = minRadius + (abs(osc.getPan() - 0.5) * maxRadius);
+    float radius = minRadius + (abs(voice.pan - 0.5) * maxRadius);
     auto mod = direction ? 1.0f : -1.0f; // determines which direction point should be from centre based on index
     return relativeCentre + (circumferencePoint * radius) * mod;
 }
@@ -92,37 +337,46 @@ juce::Point<float> jr::OscillatorVisualiser::addRandomNoiseToPoint(juce::Point<f
     return juce::Point<float>(p.getX() + ((random.nextFloat() - 0.5f) * scale), p.getY() + ((random.nextFloat() - 0.5f) * scale));
 }
 
-void jr::OscillatorVisualiser::drawWobble(juce::Graphics& g, const juce::Point<float>& p, float size)
+void jr::OscillatorVisualiser::drawWobble(juce::Graphics& g, const juce::Point<float>& p, float size, int colourBucket)
 {
+    const auto* sprites = dotSprites.data() + colourBucket * numSizeClasses;
+
     // only draw wobbles if more than 2 oscs to give effect like it is caused by interference
-    if (numActivePairs > 1)
+    auto wobbleClass = getSizeClass(size * 0.8f);
+    if (numActivePairs > 1 && wobbleClass >= 0)
     {
-        float wobbleSize = size * 0.8f;
         float centreOffset = size * 0.25f;
 
         // draw 3 extra random circles with noise from centre to create effect like the dot is shaking
         for (int i{}; i < 4; i++)
         {
-            g.fillEllipse(juce::Rectangle<float>(wobbleSize, wobbleSize).withCentre(addRandomNoiseToPoint(p, centreOffset)));
+            drawSprite(g, sprites[wobbleClass], addRandomNoiseToPoint(p, centreOffset));
         }
     }
 
-    g.fillEllipse(juce::Rectangle<float>(size, size).withCentre(p));
+    auto sizeClass = getSizeClass(size);
+    if (sizeClass >= 0)
+    {
+        drawSprite(g, sprites[sizeClass], p);
+    }
 }
 
-void jr::OscillatorVisualiser::drawSpikes(juce::Graphics& g, const juce::Point<float>& p, float size, FaderPairs::RandomOsc& osc)
+void jr::OscillatorVisualiser::drawSpikes(juce::Graphics& g, const juce::Point<float>& p, float size, const VoiceTelemetry& voice, int colourBucket)
 {
     // only draw wobbles if more than 2 oscs to give effect like it is caused by interference
     if (numActivePairs > 1)
     {
-        if (osc.getWaveShape() < 0.01f) { return; }
+        if (voice.waveShape < 0.01f) { return; }
+
+        float amount = 0.5f + 0.125f * voice.waveShape;
+        auto sizeClass = getSizeClass(size * amount);
+        if (sizeClass < 0) { return; }
 
-        float amount = 0.5f + 0.125f * osc.getWaveShape();
-        float wobbleSize = size * amount;
+        const auto* sprites = spikeSprites.data() + (colourBucket * numSizeClasses + sizeClass) * numSpikeRotations;
 
         for (int i{}; i < 10; i++)
         {
-            drawTriangle(g, wobbleSize, p, random.nextFloat() * 2.1f);
+            drawSprite(g, sprites[random.nextInt(numSpikeRotations)], p);
         }
     }
 }
@@ -140,9 +394,14 @@ void jr::OscillatorVisualiser::drawTriangle(juce::Graphics& g, float r, const ju
     g.fillPath(triangle);
 }
 
-void jr::OscillatorVisualiser::drawDotForOsc(juce::Graphics& g, FaderPairs::RandomOsc& osc, bool direction, const juce::Point<float>& circumferencePoint)
+juce::Rectangle<float> jr::OscillatorVisualiser::drawDotForVoice(juce::Graphics& g, const VoiceTelemetry& voice, bool direction, const juce::Point<float>& circumferencePoint)
 {
-    g.setColour(getColourFromOsc(osc));
-    drawWobble(g, getPointFromOsc(osc, direction, circumferencePoint), getDotSizeFromOsc(osc));
-    drawSpikes(g, getPointFromOsc(osc, direction, circumferencePoint), getDotSizeFromOsc(osc), osc);
+    auto colourBucket = getColourBucket(voice);
+    auto p = getPointFromVoice(voice, direction, circumferencePoint);
+    auto size = getDotSizeFromVoice(voice);
+    drawWobble(g, p, size, colourBucket);
+    drawSpikes(g, p, size, voice, colourBucket);
+
+    // wobbles reach 0.525 * size from the centre and spikes 0.625 * size, plus the sprites' antialiasing padding
+    return juce::Rectangle<float>(size * 1.5f + 4.0f, size * 1.5f + 4.0f).withCentre(p);
 }
@@ -10,36 +10,97 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 #include <vector>
-#include "../Audio/jr_FaderPairs.h"
+#include "../Audio/jr_Telemetry.h"
 #include "../../LookAndFeel/StyleSheet.h"
 
 namespace jr
 {
     /*
-    The visualiser component that will use an array of FaderPair objects to draw circles which represent each oscillator
+    The visualiser component that draws circles which represent each oscillator, from the telemetry frames published by the processor.
+
+    Frames are drawn on a low priority worker thread into an off-screen image, and paint() only draws the latest finished image,
+    so the message thread does almost no work. Frames are requested on each display vertical blank, but only when a new telemetry
+    frame has been published and the visualiser can be seen, and only the areas around the dots of the old and new frames are
+    repainted. When audio stops or the engine is idle nothing is redrawn at all.
+
+    Dots and spikes are drawn from pre-rendered sprites, one per colour bucket and size class (and rotation for spikes), so
+    rendering a frame is only image compositing. Sprites are rebuilt when the size, look and feel or display scale changes.
     */
-    class OscillatorVisualiser : public juce::Component
+    class OscillatorVisualiser : public juce::Component, private juce::Thread
     {
     public:
-        OscillatorVisualiser(jr::CustomLookAndFeel& _lookAndFeel) : lookAndFeel(_lookAndFeel) {}
+        OscillatorVisualiser(jr::CustomLookAndFeel& _lookAndFeel, jr::TelemetryBuffer& _telemetry);
+        ~OscillatorVisualiser() override;
 
         void paint(juce::Graphics&) override;
-        
+
+    private:
+
+        void resized() override;
+
+        void lookAndFeelChanged() override;
+
+        void run() override;
+
         /*
-        Sets the FaderPairs that will be referenced whilst painting the visualiser
+        Called on the message thread at every vertical blank. Repaints the areas changed by the last finished frame and asks
+        the worker for a new frame if there is new telemetry.
         */
-        void setPairs(std::shared_ptr<std::vector<FaderPairs::RandomOsc>> _pairs) { oscs = _pairs; }
+        void onVBlank();
 
         /*
-        Sets how many oscillators are currently active in order to limit the loops in paint. Saved as a variable in order to save
-        time from calculation every paint call
+        Returns true if the visualiser is on screen in a window that isn't minimised
         */
-        void setNumActivePairs(int _numActivePairs) { numActivePairs = _numActivePairs; }
+        bool isVisibleOnScreen();
 
-    private:
+        /*
+        Asks the worker to draw a new frame, even if the telemetry hasn't changed. Message thread only.
+        */
+        void requestFrame();
 
-        void resized() override;
+        /*
+        Draws the latest telemetry frame into the back image and swaps it to the front. Skips drawing if the frame would look the
+        same as the last one. Worker thread only.
+        */
+        void renderFrame();
+
+        /*
+        Updates the dot sizes and spread for a visualiser of the given size
+        */
+        void updateLayout(int width, int height);
+
+        /*
+        Re-renders every dot and spike sprite for the current size and colours at the given display scale
+        */
+        void updateSprites(float scale);
+
+        /*
+        Returns a sprite of a filled circle with the given diameter
+        */
+        juce::Image createDotSprite(float diameter, juce::Colour colour, float scale);
+
+        /*
+        Returns a sprite of a filled equilateral triangle that fits in a circle of radius r, rotated by offset
+        */
+        juce::Image createSpikeSprite(float r, float offset, juce::Colour colour, float scale);
+
+        /*
+        Draws a sprite centred on point c
+        */
+        void drawSprite(juce::Graphics& g, const juce::Image& sprite, const juce::Point<float>& c);
+
+        /*
+        Returns the index of the sprite size class closest to size, or -1 if size is too small to draw
+        */
+        int getSizeClass(float size);
+
+        /*
+        Returns the colour bucket for the frequency of the given voice
+        */
+        int getColourBucket(const VoiceTelemetry& voice);
 
         /*
         Returns a new Point that takes the given point p and adds random noise to both co-ordinates. Scale is 2.0f by default which results in a noise range of +/- 1.0f
@@ -52,39 +113,35 @@ namespace jr
         juce::Point<float> getCircumferencePoint(int i);
 
         /*
-        Returns a colour based on the frequency of the oscillator at the given index in the given FaderPair
-        */
-        juce::Colour getColourFromOsc(FaderPairs::RandomOsc& osc);
-
-        /*
-        Returns the size of dot to draw based on the current level of the given oscillator at the given index in the FaderPair.
+        Returns the size of dot to draw based on the RMS level of the given voice over the last telemetry interval.
         Size will be constrained between the max Dot size and 0
         */
-        float getDotSizeFromOsc(FaderPairs::RandomOsc& osc);
+        float getDotSizeFromVoice(const VoiceTelemetry& voice);
 
         /*
-        Returns the point to draw the dot at for oscillator at the given index in the FaderPair.
+        Returns the point to draw the dot at for the given voice.
         circumferencePoint is the point on a circle's circumference (with centre 0 and radius 66)
         marking the angle at which the dot should be drawn.
         */
-        const juce::Point<float> getPointFromOsc(FaderPairs::RandomOsc& osc, bool direction, const juce::Point<float>& circumferencePoint);
+        const juce::Point<float> getPointFromVoice(const VoiceTelemetry& voice, bool direction, const juce::Point<float>& circumferencePoint);
 
         /*
-        Draws a dot representation of the oscillator at the given index in the FaderPair, using
+        Draws a dot representation of the given voice, using
         circumferencePoint as the point on a 0 centred circle that matches the angle of the desired dot.
+        Returns the area that was drawn to.
         */
-        void drawDotForOsc(juce::Graphics& g, FaderPairs::RandomOsc& osc, bool direction, const juce::Point<float>& circumferencePoint);
+        juce::Rectangle<float> drawDotForVoice(juce::Graphics& g, const VoiceTelemetry& voice, bool direction, const juce::Point<float>& circumferencePoint);
 
         /*
         Draws a dot with additional overlayed dots with random noise to cause a dynamic 'buzzing'/'wobbling' effect. Draws a
-        dot with given size at point p.
+        dot with given size at point p, using the sprites of the given colour bucket.
         */
-        void drawWobble(juce::Graphics& g, const juce::Point<float>& p, float size);
-        
+        void drawWobble(juce::Graphics& g, const juce::Point<float>& p, float size, int colourBucket);
+
         /*
-        Draws spikes around the dot, spike size will be relative to waveshape of osc
+        Draws spikes around the dot, spike size will be relative to waveshape of the voice
         */
-        void drawSpikes(juce::Graphics& g, const juce::Point<float>& p, float size, FaderPairs::RandomOsc& osc);
+        void drawSpikes(juce::Graphics& g, const juce::Point<float>& p, float size, const VoiceTelemetry& voice, int colourBucket);
 
         /*
         draws an equilateral triangle with centre point c, of size that fits in circle of radius r.
@@ -92,7 +149,31 @@ namespace jr
         */
         void drawTriangle(juce::Graphics& g, float r, const juce::Point<float>& c, float offset = 0.0f);
 
+        static constexpr int numColourBuckets = 12;                             // number of distinct dot colours
+        static constexpr int numSizeClasses = 12;                               // number of distinct dot and spike sizes between 0 and maxDotSize
+        static constexpr int numSpikeRotations = 6;                             // number of distinct spike rotations
+
         jr::CustomLookAndFeel& lookAndFeel;
+        jr::TelemetryBuffer& telemetry;                                         // frames published by the processor, read by the worker thread
+
+        // shared between the message thread and the worker thread
+        std::atomic<int> componentWidth{ 0 };                                   // saved on resize so the worker never reads the component
+        std::atomic<int> componentHeight{ 0 };
+        std::atomic<float> displayScale{ 1.0f };                                // physical pixels per logical pixel, saved in paint
+        std::atomic<bool> spritesNeedUpdating{ true };
+        std::atomic<bool> workerBusy{ false };                                  // true from when a frame is requested until it is finished
+        juce::SpinLock colourLock;                                              // guards bucketColours
+        std::array<juce::Colour, numColourBuckets> bucketColours{};             // colour of each bucket, taken from the look and feel on the message thread
+        juce::SpinLock imageLock;                                               // guards frontImage and dirtyAreas
+        juce::Image frontImage;                                                 // latest finished frame
+        juce::RectangleList<int> dirtyAreas;                                    // areas changed by frames that have not been repainted yet
+
+        // message thread only
+        juce::VBlankAttachment vBlankAttachment;
+        uint32_t requestedSequence{ 0 };                                        // telemetry sequence of the last frame requested from the worker
+
+        // worker thread only
+        juce::Image backImage;                                                  // frame being drawn
         float maxDotSize{ 28.0f };                                              // maximum size for a dot in the visualiser (the size the dot will be at max volume)
         float maxRadius{ 4.0f };                                                // scale value that determines how far out the visualiser will spread out.
         float minRadius{ 0.2f };                                                // scale value that determines how clustered the visualiser will be when mono.
@@ -110,9 +191,16 @@ namespace jr
             juce::Point<float>(27.0f, -60.2f),
             juce::Point<float>(60.2f, 27.0f),
         };
-        std::shared_ptr<std::vector<FaderPairs::RandomOsc>> oscs{ nullptr };   // pointer to the array of FaderPair objects that will be visualised
         juce::Random random{};
         juce::Point<float> relativeCentre{ 0.0f, 0.0f };                        // centre of visualiser relative to its own top left corner, saved on resize to avoid unnecessary repeated conversions
+        TelemetryFrame lastFrame;                                               // the last frame that was drawn
+        juce::RectangleList<int> lastAreas;                                     // areas drawn to in the last frame, which need clearing in the next
+        int layoutWidth{ 0 };                                                   // size the layout and sprites were last calculated for
+        int layoutHeight{ 0 };
+
+        std::vector<juce::Image> dotSprites;                                    // indexed by colour bucket then size class
+        std::vector<juce::Image> spikeSprites;                                  // indexed by colour bucket, size class then rotation
+        float spriteScale{ 0.0f };                                              // display scale the sprites were rendered at
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillatorVisualiser);
     };
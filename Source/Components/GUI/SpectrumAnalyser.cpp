@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Created: 21 Oct 2026 10:31:17am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+jr::SpectrumAnalyser::SpectrumAnalyser(jr::CustomLookAndFeel& _lookAndFeel, jr::AnalyserFifo& _fifo)
+    : lookAndFeel(_lookAndFeel), fifo(_fifo), vBlankAttachment(this, [this] { onVBlank(); })
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void jr::SpectrumAnalyser::onVBlank()
+{
+    // always empty the FIFO so that stale audio isn't shown when the editor becomes visible again
+    int numPulled;
+    while ((numPulled = fifo.pull(pullBuffer.data(), fftSize)) > 0)
+    {
+        for (int i{}; i < numPulled; i++)
+        {
+            history[historyIndex] = pullBuffer[i];
+            historyIndex = (historyIndex + 1) % fftSize;
+        }
+        samplesSinceUpdate += numPulled;
+    }
+
+    if (samplesSinceUpdate >= hopSize && isShowing())
+    {
+        samplesSinceUpdate = 0;
+        updateSpectrum();
+        repaint();
+    }
+}
+
+void jr::SpectrumAnalyser::updateSpectrum()
+{
+    // unwrap the history so the oldest sample is first
+    std::copy(history.begin() + historyIndex, history.end(), fftData.begin());
+    std::copy(history.begin(), history.begin() + historyIndex, fftData.begin() + (fftSize - historyIndex));
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.0f);
+
+    window.multiplyWithWindowingTable(fftData.data(), (size_t)fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    auto sampleRate = (float)fifo.getSampleRate();
+    displayMaxFreq = juce::jmin(maxDisplayFreq, sampleRate * 0.5f);
+    auto binsPerHz = (float)fftSize / sampleRate;
+
+    // a full scale sine through a hann window peaks at fftSize / 4
+    auto magnitudeScale = 4.0f / (float)fftSize;
+
+    for (int point{}; point < numPoints; point++)
+    {
+        auto proportion = (float)point / (float)(numPoints - 1);
+        auto freq = minDisplayFreq * std::pow(displayMaxFreq / minDisplayFreq, proportion);
+
+        auto decibels = juce::Decibels::gainToDecibels(getMagnitudeAtBin(freq * binsPerHz) * magnitudeScale, minDecibels);
+        auto level = juce::jmin(1.0f, juce::jmap(decibels, minDecibels, 0.0f, 0.0f, 1.0f));
+
+        levels[point] = juce::jmax(level, levels[point] * decayPerUpdate);
+    }
+}
+
+float jr::SpectrumAnalyser::getMagnitudeAtBin(float bin)
+{
+    int index = juce::jlimit(0, fftSize / 2 - 1, (int)bin);
+    auto fraction = juce::jlimit(0.0f, 1.0f, bin - (float)index);
+    return fftData[index] + (fftData[index + 1] - fftData[index]) * fraction;
+}
+
+void jr::SpectrumAnalyser::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds().toFloat();
+    auto width = bounds.getWidth();
+    auto height = bounds.getHeight();
+
+    juce::Path spectrum;
+    spectrum.startNewSubPath(0.0f, height);
+    for (int point{}; point < numPoints; point++)
+    {
+        auto x = width * (float)point / (float)(numPoints - 1);
+        spectrum.lineTo(x, height * (1.0f - levels[point]));
+    }
+    spectrum.lineTo(width, height);
+    spectrum.closeSubPath();
+
+    auto colour = lookAndFeel.getValueTrackColour(false);
+
+    g.setColour(colour.withAlpha(0.15f));
+    g.fillPath(spectrum);
+
+    g.setColour(colour.withAlpha(0.4f));
+    g.strokePath(spectrum, juce::PathStrokeType(1.0f));
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 21 Oct 2026 10:31:17am
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+#include "../Audio/jr_AnalyserFifo.h"
+#include "../../LookAndFeel/StyleSheet.h"
+
+namespace jr
+{
+    /*
+    Draws the spectrum of the plugin output on a log frequency scale, from the samples the processor pushes into an AnalyserFifo.
+
+    All analysis happens on the message thread: at each vertical blank the new samples are pulled from the FIFO, and once enough
+    have arrived a windowed FFT is taken and the component repainted. Nothing is repainted while no audio is arriving.
+    */
+    class SpectrumAnalyser : public juce::Component
+    {
+    public:
+        SpectrumAnalyser(jr::CustomLookAndFeel& _lookAndFeel, jr::AnalyserFifo& _fifo);
+
+        void paint(juce::Graphics&) override;
+
+    private:
+        /*
+        Pulls new samples from the FIFO and updates the spectrum if enough have arrived
+        */
+        void onVBlank();
+
+        /*
+        Runs the FFT over the latest fftSize samples and updates the level of each display point
+        */
+        void updateSpectrum();
+
+        /*
+        Returns the magnitude of the FFT output at the given fractional bin, interpolating between neighbouring bins
+        */
+        float getMagnitudeAtBin(float bin);
+
+        static constexpr int fftOrder = 12;
+        static constexpr int fftSize = 1 << fftOrder;
+        static constexpr int hopSize = fftSize / 4;              // new samples needed before the spectrum is updated
+        static constexpr int numPoints = 256;                    // points drawn across the width of the component
+        static constexpr float minDisplayFreq = 20.0f;           // lowest frequency shown in Hz
+        static constexpr float maxDisplayFreq = 20000.0f;        // highest frequency shown in Hz, if below Nyquist
+        static constexpr float minDecibels = -90.0f;             // level drawn at the bottom of the component
+        static constexpr float decayPerUpdate = 0.85f;           // how much of the previous level is kept when the new level is lower
+
+        jr::CustomLookAndFeel& lookAndFeel;
+        jr::AnalyserFifo& fifo;
+
+        juce::dsp::FFT fft{ fftOrder };
+        juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann };
+
+        std::array<float, fftSize> history{};                    // latest samples from the FIFO, oldest at historyIndex
+        int historyIndex{ 0 };
+        int samplesSinceUpdate{ 0 };
+        std::array<float, fftSize> pullBuffer{};                 // samples pulled from the FIFO before they are added to history
+        std::array<float, fftSize * 2> fftData{};                // FFT input and output, the FFT needs twice the size for working
+        std::array<float, numPoints> levels{};                   // level of each display point, normalised between 0 and 1
+        float displayMaxFreq{ maxDisplayFreq };                  // highest frequency in levels
+
+        juce::VBlankAttachment vBlankAttachment;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyser);
+    };
+}
@@ -42,6 +42,8 @@ namespace jr
             slider.updateText();
         }
 
+        ~TwoHeadedSliderAttachment() override { slider.removeListener(this); }
+
         /*
         Update from GUI to parameter state - needs to take minValue and maxValue of slider and set to params.
         If getIsLocked returns true, 
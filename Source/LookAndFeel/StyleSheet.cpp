@@ -17,7 +17,15 @@
 jr::CustomLookAndFeel::CustomLookAndFeel()
 {
     updateTextColour();
-    setDefaultSansSerifTypeface(StyleSheet::boldFont);
+}
+
+juce::Typeface::Ptr jr::CustomLookAndFeel::getTypefaceForFont(const juce::Font& font)
+{
+    if (font.getTypefaceName() == juce::Font::getDefaultSansSerifFontName())
+    {
+        return resources->getBoldTypeface();
+    }
+    return LookAndFeel_V4::getTypefaceForFont(font);
 }
 
 void jr::CustomLookAndFeel::updateTextColour()
@@ -11,16 +11,7 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "Resources/FontResources.h"
-
-// fonts
-namespace StyleSheet
-{
-
-    static juce::Typeface::Ptr boldFont  { juce::Typeface::createSystemTypefaceFor (Resources::WorkSansSemiBold_ttf, Resources::WorkSansSemiBold_ttfSize) };
-    static juce::Typeface::Ptr plainFont { juce::Typeface::createSystemTypefaceFor (Resources::WorkSansRegular_ttf, Resources::WorkSansRegular_ttfSize) };
-
-}
+#include "../Utils/jr_SharedResources.h"
 
 namespace jr
 {
@@ -41,6 +32,12 @@ namespace jr
             void drawToggleButton(juce::Graphics& g, juce::ToggleButton& button,
                 bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown) override;
 
+            /*
+            Uses the shared WorkSans typeface for the default sans serif font. It is decoded the first time any text is drawn,
+            rather than when the look and feel is created.
+            */
+            juce::Typeface::Ptr getTypefaceForFont(const juce::Font& font) override;
+
             juce::Colour getValueTrackColour(bool isFrozen) { return isFrozen ? getFrozenColour() : getAccentColour(); }
 
             juce::Colour getBackgroundColour() { return darkMode ? jet : beige; }
@@ -87,6 +84,8 @@ namespace jr
 
             bool darkMode{ false };
 
+            juce::SharedResourcePointer<SharedResources> resources;   // fonts are decoded once on first use and shared by every editor
+
             juce::Colour verdigris{ juce::Colour(104, 149, 161) };
             juce::Colour roseQuartz{ juce::Colour(150, 134, 172) };
             juce::Colour beige{ juce::Colour(249, 245, 241) };
@@ -12,7 +12,8 @@
 
 //==============================================================================
 MultiFaderDroneAudioProcessorEditor::MultiFaderDroneAudioProcessorEditor (MultiFaderDroneAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), analyser (myLookAndFeel, p.getAnalyserFifo()), visualiser (myLookAndFeel, p.getTelemetry()),
+      levelMeter (myLookAndFeel, p.getOutputMeter()), audioProcessor (p)
 {
     juce::LookAndFeel::setDefaultLookAndFeel(&myLookAndFeel);
     setLookAndFeel(&myLookAndFeel);
@@ -38,12 +39,7 @@ MultiFaderDroneAudioProcessorEditor::MultiFaderDroneAudioProcessorEditor (MultiF
     // APVTS Attachments
 
     gainAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), ID::GAIN.toString(), gainSlider);
-    lfoRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), ID::RATE.toString(), lfoRateSlider);
-    voicesAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), ID::NUM_VOICES.toString(), voicesSlider);
-    stereoWidthAttachment = std::make_unique<jr::MirrorSliderAttachment>(*(audioProcessor.getAPVTS().getParameter(ID::STEREO_WIDTH)), stereoSlider);
-    freqRangeAttachment = std::make_unique<jr::TwoHeadedSliderAttachment>(*(audioProcessor.getAPVTS().getParameter(ID::FREQ_RANGE_MIN)),
-        *(audioProcessor.getAPVTS().getParameter(ID::FREQ_RANGE_MAX)), freqRangeSlider, [&]() { return audioProcessor.getRangeLocked(); });
-    waveShapeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(audioProcessor.getAPVTS(), ID::WAVE_SHAPE.toString(), waveShapeSlider);
+    selectLayer(0);
 
     // buttons
 
@@ -54,13 +50,34 @@ MultiFaderDroneAudioProcessorEditor::MultiFaderDroneAudioProcessorEditor (MultiF
     darkModeButton.addListener(this);
     addAndMakeVisible(darkModeButton);
 
+    for (auto* sceneButton : { &sceneAButton, &sceneBButton })
+    {
+        sceneButton->addListener(this);
+        addAndMakeVisible(sceneButton);
+    }
+
+    scaleButton.addListener(this);
+    addAndMakeVisible(scaleButton);
+
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        auto& layerButton = layerButtons[(size_t)layer];
+        layerButton.setButtonText("L" + juce::String(layer + 1));
+        layerButton.setClickingTogglesState(true);
+        layerButton.setRadioGroupId(1);
+        layerButton.setToggleState(layer == selectedLayer, juce::dontSendNotification);
+        layerButton.addListener(this);
+        addAndMakeVisible(layerButton);
+    }
+
     lockRangeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getAPVTS(), ID::LOCK_RANGE.toString(), lockRangeButton);
     darkModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(audioProcessor.getAPVTS(), ID::DARK_MODE.toString(), darkModeButton);
 
     // other visuals
 
-    visualiser.setPairs(audioProcessor.getOscs());
+    addAndMakeVisible(analyser);
     addAndMakeVisible(visualiser);
+    addAndMakeVisible(levelMeter);
 
     addAndMakeVisible(sineIcon);
     sineIcon.setLookAndFeel(&myLookAndFeel);
@@ -70,8 +87,6 @@ MultiFaderDroneAudioProcessorEditor::MultiFaderDroneAudioProcessorEditor (MultiF
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     setSize(600, 600);
-
-    startTimerHz(24); // FPS
 }
 
 void MultiFaderDroneAudioProcessorEditor::initSimpleSlider(juce::Slider* slider, juce::Label* label, const juce::String& name) {
@@ -97,17 +112,9 @@ MultiFaderDroneAudioProcessorEditor::~MultiFaderDroneAudioProcessorEditor()
 {
     setLookAndFeel(nullptr);
     juce::LookAndFeel::setDefaultLookAndFeel(nullptr);
-    stopTimer();
 }
 
 //==============================================================================
-void MultiFaderDroneAudioProcessorEditor::timerCallback()
-{
-    visualiser.setPairs(audioProcessor.getOscs());
-    visualiser.setNumActivePairs(voicesSlider.getValue());
-    visualiser.repaint();
-}
-
 void MultiFaderDroneAudioProcessorEditor::paint (juce::Graphics& g)
 {
     g.fillAll(myLookAndFeel.getBackgroundColour());
@@ -125,10 +132,25 @@ void MultiFaderDroneAudioProcessorEditor::resized()
 
     lockRangeButton.setBoundsRelative(0.03f, 0.65f, 0.4f, 0.1f);
 
+    sceneAButton.setBoundsRelative(0.79f, 0.67f, 0.08f, 0.06f);
+
+    sceneBButton.setBoundsRelative(0.89f, 0.67f, 0.08f, 0.06f);
+
+    scaleButton.setBoundsRelative(0.79f, 0.735f, 0.18f, 0.05f);
+
+    analyser.setBoundsRelative(0.25f, 0.3f, 0.5f, 0.5f);
+
     visualiser.setBoundsRelative(0.25f, 0.3f, 0.5f, 0.5f);
 
     darkModeButton.setBoundsRelative(0.92f, 0.0f, 0.06f, 0.06f);
 
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        layerButtons[(size_t)layer].setBoundsRelative(0.02f + (float)layer * 0.065f, 0.01f, 0.055f, 0.05f);
+    }
+
+    levelMeter.setBoundsRelative(0.3f, 0.01f, 0.4f, 0.04f);
+
     stereoSlider.setBoundsRelative(0.02f, 0.8f, 0.96f, 0.08f);
 
     sineIcon.setBoundsRelative(0.02f, 0.92f, 0.08f, 0.08f);
@@ -145,6 +167,81 @@ void MultiFaderDroneAudioProcessorEditor::buttonClicked(juce::Button* button)
         myLookAndFeel.setIsDarkMode(darkModeButton.getToggleStateValue().getValue());
         refreshStyles();
     }
+    else if (button == &sceneAButton || button == &sceneBButton)
+    {
+        int sceneIndex = button == &sceneAButton ? 0 : 1;
+
+        if (juce::ModifierKeys::currentModifiers.isShiftDown())
+        {
+            audioProcessor.storeScene(sceneIndex);
+        }
+        else
+        {
+            audioProcessor.morphToScene(sceneIndex);
+        }
+    }
+    else if (button == &scaleButton)
+    {
+        chooseScale();
+    }
+    else
+    {
+        for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+        {
+            if (button == &layerButtons[(size_t)layer] && button->getToggleState() && layer != selectedLayer)
+            {
+                selectLayer(layer);
+            }
+        }
+    }
+}
+
+void MultiFaderDroneAudioProcessorEditor::selectLayer(int layer)
+{
+    selectedLayer = layer;
+    auto& apvts = audioProcessor.getAPVTS();
+
+    // the old attachments have to go before the new ones take over the sliders
+    lfoRateAttachment.reset();
+    voicesAttachment.reset();
+    waveShapeAttachment.reset();
+    stereoWidthAttachment.reset();
+    freqRangeAttachment.reset();
+
+    // the two headed attachment sets the max head first, which can't go below the min head of the previous layer
+    freqRangeSlider.setMinAndMaxValues(freqRangeSlider.getMinimum(), freqRangeSlider.getMaximum(), juce::dontSendNotification);
+
+    lfoRateAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID::getLayerID(ID::RATE, layer), lfoRateSlider);
+    voicesAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID::getLayerID(ID::NUM_VOICES, layer), voicesSlider);
+    stereoWidthAttachment = std::make_unique<jr::MirrorSliderAttachment>(*(apvts.getParameter(ID::getLayerID(ID::STEREO_WIDTH, layer))), stereoSlider);
+    freqRangeAttachment = std::make_unique<jr::TwoHeadedSliderAttachment>(*(apvts.getParameter(ID::getLayerID(ID::FREQ_RANGE_MIN, layer))),
+        *(apvts.getParameter(ID::getLayerID(ID::FREQ_RANGE_MAX, layer))), freqRangeSlider, [&]() { return audioProcessor.getRangeLocked(); });
+    waveShapeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(apvts, ID::getLayerID(ID::WAVE_SHAPE, layer), waveShapeSlider);
+}
+
+void MultiFaderDroneAudioProcessorEditor::chooseScale()
+{
+    scaleChooser = std::make_unique<juce::FileChooser>("Load Scala Scale", juce::File(), "*.scl");
+    auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+
+    scaleChooser->launchAsync(flags, [&](const juce::FileChooser& chooser)
+        {
+            auto file = chooser.getResult();
+            if (file == juce::File())
+            {
+                return;
+            }
+
+            if (!audioProcessor.loadScale(file))
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Load Scala Scale",
+                                                       file.getFileName() + " isn't a Scala scale that can be used.");
+                return;
+            }
+
+            auto* pitchMode = audioProcessor.getAPVTS().getParameter(ID::PITCH_MODE.toString());
+            pitchMode->setValueNotifyingHost(pitchMode->convertTo0to1((float)jr::PitchTable::Mode::scala));
+        });
 }
 
 void MultiFaderDroneAudioProcessorEditor::refreshStyles()
@@ -156,6 +253,13 @@ void MultiFaderDroneAudioProcessorEditor::refreshStyles()
 void MultiFaderDroneAudioProcessorEditor::sendNewLookAndFeel()
 {
     lockRangeButton.sendLookAndFeelChange();
+    sceneAButton.sendLookAndFeelChange();
+    sceneBButton.sendLookAndFeelChange();
+    scaleButton.sendLookAndFeelChange();
+    for (auto& layerButton : layerButtons)
+    {
+        layerButton.sendLookAndFeelChange();
+    }
     freqRangeSlider.sendLookAndFeelChange();
     lfoRateSlider.sendLookAndFeelChange();
     voicesSlider.sendLookAndFeelChange();
@@ -168,4 +272,7 @@ void MultiFaderDroneAudioProcessorEditor::sendNewLookAndFeel()
     stereoLabel.sendLookAndFeelChange();
     sineIcon.sendLookAndFeelChange();
     triangleIcon.sendLookAndFeelChange();
+    analyser.sendLookAndFeelChange();
+    visualiser.sendLookAndFeelChange();
+    levelMeter.repaint();
 }
\ No newline at end of file
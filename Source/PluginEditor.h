@@ -13,6 +13,8 @@
 #include "LookAndFeel/StyleSheet.h"
 #include <memory>
 #include "Components/GUI/OscillatorVisualiser.h"
+#include "Components/GUI/SpectrumAnalyser.h"
+#include "Components/GUI/LevelMeter.h"
 #include "Components/GUI/MirrorSliderAttachment.h"
 #include "Components/GUI/TwoHeadedSliderAttachment.h"
 #include "Components/GUI/LockingTwoHeadedSlider.h"
@@ -23,7 +25,7 @@
 //==============================================================================
 /**
 */
-class MultiFaderDroneAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Timer, public juce::Button::Listener
+class MultiFaderDroneAudioProcessorEditor  : public juce::AudioProcessorEditor, public juce::Button::Listener
 {
 public:
     MultiFaderDroneAudioProcessorEditor (MultiFaderDroneAudioProcessor&);
@@ -35,8 +37,6 @@ public:
 
     void buttonClicked(juce::Button* button) override;
 
-    void timerCallback() override;
-
 private:
     // helpers
 
@@ -54,6 +54,16 @@ private:
     */
     void refreshStyles();
 
+    /*
+    Opens a file browser for a Scala file, and loads the chosen file as the scale
+    */
+    void chooseScale();
+
+    /*
+    Attaches the layer sliders to the parameters of the given drone layer
+    */
+    void selectLayer(int layer);
+
     jr::CustomLookAndFeel myLookAndFeel;
 
     // sliders and labels
@@ -80,13 +90,22 @@ private:
     
     juce::ToggleButton lockRangeButton{ "Lock Range" };
     jr::DarkModeButton darkModeButton{};
+    juce::TextButton sceneAButton{ "A" }, sceneBButton{ "B" };    // click to morph to the scene, shift-click to store the current settings in it
+    juce::TextButton scaleButton{ "Scale" };                        // loads a Scala file and switches to the Scala pitch mode
+    std::array<juce::TextButton, FaderPairs::maxNumLayers> layerButtons;   // picks the drone layer the layer sliders control
+    int selectedLayer{ 0 };
+
+    std::unique_ptr<juce::FileChooser> scaleChooser;                // kept alive while the file browser is open
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> lockRangeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> darkModeAttachment;
 
     // Visualiser
 
-    jr::OscillatorVisualiser visualiser{ myLookAndFeel };
+    jr::SpectrumAnalyser analyser;      // drawn behind the visualiser
+    jr::OscillatorVisualiser visualiser;
+
+    jr::LevelMeter levelMeter;
 
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
@@ -25,23 +25,73 @@ MultiFaderDroneAudioProcessor::MultiFaderDroneAudioProcessor()
 #endif
 {
     apvts.addParameterListener(ID::GAIN.toString(), &gainListener);
-    apvts.addParameterListener(ID::RATE.toString(), &rateListener);
-    apvts.addParameterListener(ID::NUM_VOICES.toString(), &voicesListener);
-    apvts.addParameterListener(ID::STEREO_WIDTH.toString(), &stereoWidthListener);
-    apvts.addParameterListener(ID::FREQ_RANGE_MIN.toString(), &minFreqRangeListener);
-    apvts.addParameterListener(ID::FREQ_RANGE_MAX.toString(), &maxFreqRangeListener);
-    apvts.addParameterListener(ID::WAVE_SHAPE.toString(), &waveShapeListener);
+    apvts.addParameterListener(ID::ENGINE.toString(), &engineListener);
+    apvts.addParameterListener(ID::NUM_PARTIALS.toString(), &partialsListener);
+    apvts.addParameterListener(ID::FREEZE.toString(), &freezeListener);
+    apvts.addParameterListener(ID::LOOKAHEAD.toString(), &lookaheadListener);
+    apvts.addParameterListener(ID::LIMITER.toString(), &limiterListener);
+    apvts.addParameterListener(ID::FADE_CURVE.toString(), &fadeCurveListener);
+    apvts.addParameterListener(ID::PITCH_MODE.toString(), &pitchModeListener);
+    apvts.addParameterListener(ID::ROOT_NOTE.toString(), &rootNoteListener);
+    apvts.addParameterListener(ID::GLIDE_TIME.toString(), &glideTimeListener);
+
+    for (auto& id : engineParameterIDs)
+    {
+        apvts.addParameterListener(id.toString(), &engineChangedListener);
+    }
+
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        auto& listeners = layerListeners[(size_t)layer];
+        listeners.voices.setCallback([this, layer](float newValue) { if (!loadingState) setNumOscs(layer, (int)newValue); });
+        listeners.rate.setCallback([this, layer](float newValue) { if (!loadingState) setLfoRate(layer, newValue); });
+        listeners.stereoWidth.setCallback([this, layer](float newValue) { if (!loadingState) setStereoWidth(layer, newValue); });
+        listeners.minFreq.setCallback([this, layer](float newValue) { if (!loadingState) setMinOscFreq(layer, newValue); });
+        listeners.maxFreq.setCallback([this, layer](float newValue) { if (!loadingState) setMaxOscFreq(layer, newValue); });
+        listeners.waveShape.setCallback([this, layer](float newValue) { if (!loadingState) setWaveShape(layer, newValue); });
+
+        for (auto& [id, listener] : getLayerParameters(layer))
+        {
+            apvts.addParameterListener(id, listener);
+            apvts.addParameterListener(id, &engineChangedListener);
+        }
+    }
+
+    savedSnapshot.voices.reserve((size_t)(maxOscCount * FaderPairs::maxNumLayers));
+    loadedSnapshot.voices.reserve((size_t)(maxOscCount * FaderPairs::maxNumLayers));
+    capturedSnapshot.voices.reserve((size_t)(maxOscCount * FaderPairs::maxNumLayers));
+
+    startTimer(pitchTablePollMs);
 }
 
 MultiFaderDroneAudioProcessor::~MultiFaderDroneAudioProcessor()
 {
+    stopTimer();
+
     apvts.removeParameterListener(ID::GAIN.toString(), &gainListener);
-    apvts.removeParameterListener(ID::RATE.toString(), &rateListener);
-    apvts.removeParameterListener(ID::NUM_VOICES.toString(), &voicesListener);
-    apvts.removeParameterListener(ID::STEREO_WIDTH.toString(), &stereoWidthListener);
-    apvts.removeParameterListener(ID::FREQ_RANGE_MIN.toString(), &minFreqRangeListener);
-    apvts.removeParameterListener(ID::FREQ_RANGE_MAX.toString(), &maxFreqRangeListener);
-    apvts.removeParameterListener(ID::WAVE_SHAPE.toString(), &waveShapeListener);
+    apvts.removeParameterListener(ID::ENGINE.toString(), &engineListener);
+    apvts.removeParameterListener(ID::NUM_PARTIALS.toString(), &partialsListener);
+    apvts.removeParameterListener(ID::FREEZE.toString(), &freezeListener);
+    apvts.removeParameterListener(ID::LOOKAHEAD.toString(), &lookaheadListener);
+    apvts.removeParameterListener(ID::LIMITER.toString(), &limiterListener);
+    apvts.removeParameterListener(ID::FADE_CURVE.toString(), &fadeCurveListener);
+    apvts.removeParameterListener(ID::PITCH_MODE.toString(), &pitchModeListener);
+    apvts.removeParameterListener(ID::ROOT_NOTE.toString(), &rootNoteListener);
+    apvts.removeParameterListener(ID::GLIDE_TIME.toString(), &glideTimeListener);
+
+    for (auto& id : engineParameterIDs)
+    {
+        apvts.removeParameterListener(id.toString(), &engineChangedListener);
+    }
+
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        for (auto& [id, listener] : getLayerParameters(layer))
+        {
+            apvts.removeParameterListener(id, listener);
+            apvts.removeParameterListener(id, &engineChangedListener);
+        }
+    }
 }
 
 //==============================================================================
@@ -110,14 +160,49 @@ void MultiFaderDroneAudioProcessor::changeProgramName (int index, const juce::St
 void MultiFaderDroneAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
     int currentNumVoices = floor(*apvts.getRawParameterValue(ID::NUM_VOICES.toString()));
-    faders.init(currentNumVoices, sampleRate, maxOscCount);
+    int currentNumPartials = (int)*apvts.getRawParameterValue(ID::NUM_PARTIALS.toString());
+    setEngine((int)*apvts.getRawParameterValue(ID::ENGINE.toString()));
+    setFadeCurve((int)*apvts.getRawParameterValue(ID::FADE_CURVE.toString()));
+    setGlideTime(*apvts.getRawParameterValue(ID::GLIDE_TIME.toString()));
+    faders.setOutputLayout(getBusesLayout().getMainOutputChannelSet());
+
+    // init sizes the first layer from currentNumVoices, the others play the voices recorded here
+    auto settings = getSettings();
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        faders.applyLayerSettings(layer, settings.layers[(size_t)layer]);
+    }
+
+    if (faders.needsPitchTable())
+    {
+        faders.buildPitchTable();
+    }
+    faders.init(currentNumVoices, sampleRate, maxOscCount, samplesPerBlock);
+    faders.initSpectral(currentNumPartials, maxPartialCount);
+    frozenDrone.prepare(sampleRate, samplesPerBlock, getBusesLayout().getMainOutputChannelSet());
+    setFrozen((bool)*apvts.getRawParameterValue(ID::FREEZE.toString()));
+    renderer.prepare(getTotalNumOutputChannels(), samplesPerBlock);
+    setLookahead((bool)*apvts.getRawParameterValue(ID::LOOKAHEAD.toString()));
+    telemetryInterval = juce::jmax(1, (int)(sampleRate / telemetryRateHz));
+    samplesUntilTelemetry = 0;
+    snapshotInterval = juce::jmax(1, (int)(sampleRate * snapshotSeconds));
+    samplesUntilSnapshot = 0;
+    analyserFifo.prepare(sampleRate, samplesPerBlock);
+    morph.prepare(sampleRate);
+    limiter.prepare(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
+    setLimiter((bool)*apvts.getRawParameterValue(ID::LIMITER.toString()));
+    outputMeter.prepare(sampleRate, getTotalNumOutputChannels(), samplesPerBlock);
     gain.reset(sampleRate, 0.1f);
+
+    // every instance logs the same figure while the store is shared, rather than adding its own copy
+    juce::Logger::writeToLog("Shared resources: " + juce::String((juce::int64)getSharedResourceFootprint()) + " bytes");
 }
 
 void MultiFaderDroneAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    renderer.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -127,12 +212,10 @@ bool MultiFaderDroneAudioProcessor::isBusesLayoutSupported (const BusesLayout& l
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
+    // Mono, stereo, any other layout of up to 16 channels (played as a speaker ring) and ambisonics up to third order are supported.
     // Some plugin hosts, such as certain GarageBand versions, will only
     // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    if (!jr::Panner::isLayoutSupported(layouts.getMainOutputChannelSet()))
         return false;
 
     // This checks if the input layout matches the output layout
@@ -168,21 +251,349 @@ void MultiFaderDroneAudioProcessor::processBlock(juce::AudioBuffer<float>& buffe
     // Alternatively, you can process the samples with the channels
     // interleaved by keeping the same state.
 
-    float numSamples = buffer.getNumSamples();
+    int numSamples = buffer.getNumSamples();
+
+    queueRootEvents(midiMessages);
 
-    float* leftChannel = buffer.getWritePointer(0);
-    float* rightChannel = buffer.getWritePointer(1);
-    
     //======================================== DSP LOOP ========================================
-    for (int i = 0; i < numSamples; i++)
+    renderer.process(buffer);
+
+    auto startGain = gain.getCurrentValue();
+    buffer.applyGainRamp(0, numSamples, startGain, gain.skip(numSamples));
+
+    limiter.process(buffer);
+    outputMeter.process(buffer);
+    analyserFifo.push(buffer);
+}
+
+void MultiFaderDroneAudioProcessor::renderBlock(juce::AudioBuffer<float>& block)
+{
+    if (settingsPending.load() || snapshotPending.load() || morphPending.load())
+    {
+        exchangeState();
+    }
+
+    // split the block at each MIDI event, so the root moves on the sample the note arrived at. With lookahead on, events are
+    // applied in the next block the thread renders, which is ahead of the block they arrived in.
+    int numSamples = block.getNumSamples();
+    int startSample = 0;
+    while (rootEventFifo.getNumReady() > 0)
+    {
+        int start1, size1, start2, size2;
+        rootEventFifo.prepareToRead(1, start1, size1, start2, size2);
+        auto event = rootEvents[(size_t)start1];
+        rootEventFifo.finishedRead(1);
+
+        int eventSample = juce::jlimit(startSample, numSamples, event.sampleOffset);
+        renderSection(block, startSample, eventSample - startSample);
+        startSample = eventSample;
+        applyRootEvent(event.note);
+    }
+    renderSection(block, startSample, numSamples - startSample);
+    updateSnapshot(numSamples);
+}
+
+void MultiFaderDroneAudioProcessor::renderSection(juce::AudioBuffer<float>& block, int startSample, int numSamples)
+{
+    if (numSamples <= 0)
+    {
+        return;
+    }
+
+    juce::AudioBuffer<float> section{ block.getArrayOfWritePointers(), block.getNumChannels(), startSample, numSamples };
+
+    processMorph(numSamples);
+
+    frozenDrone.process(section, faders);
+
+    samplesUntilTelemetry -= numSamples;
+    if (samplesUntilTelemetry <= 0)
+    {
+        samplesUntilTelemetry = juce::jmax(1, samplesUntilTelemetry + telemetryInterval);
+        faders.writeTelemetry(telemetry.getWriteFrame());
+        telemetry.publish();
+    }
+}
+
+void MultiFaderDroneAudioProcessor::queueRootEvents(const juce::MidiBuffer& midi)
+{
+    for (const auto metadata : midi)
+    {
+        if (metadata.numBytes < 3)
+        {
+            continue;
+        }
+
+        auto status = metadata.data[0] & 0xf0;
+        auto data1 = (int)metadata.data[1];
+        int note;
+        if (status == 0x90 && metadata.data[2] > 0)
+        {
+            note = data1;
+        }
+        else if (status == 0xb0 && (data1 == 120 || data1 == 123))     // all sound off, all notes off
+        {
+            note = -1;
+        }
+        else
+        {
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        rootEventFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 == 0)
+        {
+            return;     // full, the rest are dropped rather than waiting for the renderer
+        }
+        rootEvents[(size_t)start1] = { note, metadata.samplePosition };
+        rootEventFifo.finishedWrite(1);
+    }
+}
+
+void MultiFaderDroneAudioProcessor::applyRootEvent(int note)
+{
+    // notes are relative to the root note parameter, so playing it puts the drone back where the parameter has it
+    auto semitones = note < 0 ? 0.0f : (float)note - *apvts.getRawParameterValue(ID::ROOT_NOTE.toString());
+    if (semitones == rootTransposition)
+    {
+        return;
+    }
+
+    rootTransposition = semitones;
+    faders.setTransposition(semitones);
+    midiTransposition = semitones;
+
+    // the live voices glide while the frozen loop is rendered again for the new root, which the timer passes on
+    frozenDrone.deferRender();
+}
+
+void MultiFaderDroneAudioProcessor::timerCallback()
+{
+    frozenDrone.setTransposition(midiTransposition.load());
+
+    // if the audio thread hasn't picked up the last table yet this does nothing, and it is tried again on the next tick
+    if (faders.needsPitchTable())
+    {
+        faders.buildPitchTable();
+    }
+}
+
+void MultiFaderDroneAudioProcessor::exchangeState()
+{
+    const juce::SpinLock::ScopedTryLockType lock(stateLock);
+    if (!lock.isLocked())
+    {
+        return;
+    }
+
+    bool hasLoaded{ false };
+
+    if (settingsPending.exchange(false))
+    {
+        // the parameters are read here rather than when they were loaded, so automation that arrived while the listeners
+        // were held off is applied as well. If another load is part way through, it sets the flag again when it finishes.
+        morph.cancel();
+        faders.applySettings(getSettings());
+        hasLoaded = true;
+    }
+
+    if (snapshotPending.exchange(false))
+    {
+        faders.restoreSnapshot(loadedSnapshot);
+        hasLoaded = true;
+    }
+
+    if (hasLoaded)
     {
-        auto sampleOut = faders.process();
+        // the lock is already held, so the loaded state is what gets saved from now on
+        faders.captureSnapshot(savedSnapshot);
+        snapshotUnpublished = false;
+        samplesUntilSnapshot = snapshotInterval;
+    }
+
+    if (morphPending.exchange(false))
+    {
+        // a morph that is interrupted by another carries on from wherever it had got to
+        morphInterrupted = false;
+        // the parameters already hold the target, along with any automation that arrived while they were being set
+        morph.start(morph.isActive() ? morph.getCurrent() : pendingMorphFrom, getSettings(), pendingMorphSeconds);
+    }
+}
+
+void MultiFaderDroneAudioProcessor::updateSnapshot(int numSamples)
+{
+    samplesUntilSnapshot -= numSamples;
+    if (samplesUntilSnapshot <= 0)
+    {
+        samplesUntilSnapshot = juce::jmax(1, samplesUntilSnapshot + snapshotInterval);
+        faders.captureSnapshot(capturedSnapshot);
+        snapshotUnpublished = true;
+    }
+
+    if (!snapshotUnpublished)
+    {
+        return;
+    }
+
+    // swapping keeps the capacity of both, so nothing is allocated. If getStateInformation is writing, try again next block.
+    const juce::SpinLock::ScopedTryLockType lock(stateLock);
+    if (lock.isLocked())
+    {
+        std::swap(savedSnapshot, capturedSnapshot);
+        snapshotUnpublished = false;
+    }
+}
+
+void MultiFaderDroneAudioProcessor::processMorph(int numSamples)
+{
+    if (!morph.isActive())
+    {
+        return;
+    }
+
+    if (morphInterrupted.exchange(false))
+    {
+        // the parameters already hold the morph's target, so the engine jumps to them along with the change that was made
+        morph.cancel();
+        faders.applySettings(getSettings());
+        return;
+    }
+
+    morph.process(faders, numSamples);
+    frozenDrone.deferRender();
+}
+
+void MultiFaderDroneAudioProcessor::onEngineParameterChanged()
+{
+    frozenDrone.invalidate();
+
+    if (!loadingState)
+    {
+        morphInterrupted = true;
+    }
+}
+
+void MultiFaderDroneAudioProcessor::setEngineParameters(const FaderPairs::Settings& settings)
+{
+    auto setParameter = [&](const juce::String& id, float value)
+        {
+            auto* parameter = apvts.getParameter(id);
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+
+    loadingState = true;
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        auto& layerSettings = settings.layers[(size_t)layer];
+        setParameter(ID::getLayerID(ID::NUM_VOICES, layer), (float)layerSettings.numOscs);
+        setParameter(ID::getLayerID(ID::RATE, layer), layerSettings.lfoRate);
+        setParameter(ID::getLayerID(ID::FREQ_RANGE_MIN, layer), layerSettings.minFreq);
+        setParameter(ID::getLayerID(ID::FREQ_RANGE_MAX, layer), layerSettings.maxFreq);
+        setParameter(ID::getLayerID(ID::STEREO_WIDTH, layer), layerSettings.stereoWidth);
+        setParameter(ID::getLayerID(ID::WAVE_SHAPE, layer), layerSettings.waveShape);
+    }
+    setParameter(ID::NUM_PARTIALS.toString(), (float)settings.numPartials);
+    setParameter(ID::ENGINE.toString(), settings.engine == FaderPairs::Engine::spectral ? 1.0f : 0.0f);
+    setParameter(ID::PITCH_MODE.toString(), (float)settings.pitchMode);
+    setParameter(ID::ROOT_NOTE.toString(), settings.rootNote);
+    loadingState = false;
+}
+
+void MultiFaderDroneAudioProcessor::storeScene(int sceneIndex)
+{
+    if (!juce::isPositiveAndBelow(sceneIndex, jr::PresetMorph::numScenes))
+    {
+        return;
+    }
+
+    auto& scene = scenes[(size_t)sceneIndex];
+    scene.settings = getSettings();
+    scene.isStored = true;
+}
 
-        gain.getNextValue();
+void MultiFaderDroneAudioProcessor::morphToScene(int sceneIndex)
+{
+    if (!hasScene(sceneIndex))
+    {
+        return;
+    }
+
+    auto from = getSettings();
+    auto& to = scenes[(size_t)sceneIndex].settings;
+
+    // the parameters show where the morph is heading, the engine is moved there by the morph
+    setEngineParameters(to);
+
+    const juce::SpinLock::ScopedLockType lock(stateLock);
+    pendingMorphFrom = from;
+    pendingMorphSeconds = *apvts.getRawParameterValue(ID::MORPH_TIME.toString());
+    morphPending = true;
+}
+
+FaderPairs::Settings MultiFaderDroneAudioProcessor::getSettings()
+{
+    FaderPairs::Settings settings;
+    for (int layer{}; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        auto& layerSettings = settings.layers[(size_t)layer];
+        layerSettings.numOscs = (int)*apvts.getRawParameterValue(ID::getLayerID(ID::NUM_VOICES, layer));
+        layerSettings.lfoRate = jr::Utils::constrainFloat(*apvts.getRawParameterValue(ID::getLayerID(ID::RATE, layer)));
+        layerSettings.minFreq = *apvts.getRawParameterValue(ID::getLayerID(ID::FREQ_RANGE_MIN, layer));
+        layerSettings.maxFreq = *apvts.getRawParameterValue(ID::getLayerID(ID::FREQ_RANGE_MAX, layer));
+        layerSettings.stereoWidth = jr::Utils::constrainFloat(*apvts.getRawParameterValue(ID::getLayerID(ID::STEREO_WIDTH, layer)));
+        layerSettings.waveShape = *apvts.getRawParameterValue(ID::getLayerID(ID::WAVE_SHAPE, layer));
+    }
+    settings.numPartials = (int)*apvts.getRawParameterValue(ID::NUM_PARTIALS.toString());
+    settings.engine = (int)*apvts.getRawParameterValue(ID::ENGINE.toString()) == 1 ? FaderPairs::Engine::spectral : FaderPairs::Engine::oscillators;
+    settings.pitchMode = (jr::PitchTable::Mode)juce::jlimit(0, (int)jr::PitchTable::Mode::scala, (int)*apvts.getRawParameterValue(ID::PITCH_MODE.toString()));
+    settings.rootNote = *apvts.getRawParameterValue(ID::ROOT_NOTE.toString());
+    return settings;
+}
+
+std::array<std::pair<juce::String, jr::ApvtsListener*>, 6> MultiFaderDroneAudioProcessor::getLayerParameters(int layer)
+{
+    auto& listeners = layerListeners[(size_t)layer];
+    return { {
+        { ID::getLayerID(ID::NUM_VOICES, layer), &listeners.voices },
+        { ID::getLayerID(ID::RATE, layer), &listeners.rate },
+        { ID::getLayerID(ID::STEREO_WIDTH, layer), &listeners.stereoWidth },
+        { ID::getLayerID(ID::FREQ_RANGE_MIN, layer), &listeners.minFreq },
+        { ID::getLayerID(ID::FREQ_RANGE_MAX, layer), &listeners.maxFreq },
+        { ID::getLayerID(ID::WAVE_SHAPE, layer), &listeners.waveShape }
+    } };
+}
+
+bool MultiFaderDroneAudioProcessor::loadScale(const juce::File& file)
+{
+    jr::PitchTable::Scale loaded;
+    juce::String description;
+    if (!jr::PitchTable::parseScala(file.loadFileAsString(), loaded, description))
+    {
+        return false;
+    }
+
+    // a scale without a description is named after its file
+    if (description.isEmpty())
+    {
+        description = file.getFileNameWithoutExtension();
+    }
 
-        leftChannel[i] = sampleOut.first * gain.getCurrentValue();
-        rightChannel[i] = sampleOut.second * gain.getCurrentValue();
+    {
+        const juce::SpinLock::ScopedLockType lock(stateLock);
+        scale = loaded;
+        scaleDescription = description;
     }
+
+    faders.setScale(loaded);
+    frozenDrone.setScale(loaded);
+    return true;
+}
+
+juce::String MultiFaderDroneAudioProcessor::getScaleDescription()
+{
+    const juce::SpinLock::ScopedLockType lock(stateLock);
+    return scaleDescription;
 }
 
 //==============================================================================
@@ -199,20 +610,62 @@ juce::AudioProcessorEditor* MultiFaderDroneAudioProcessor::createEditor()
 //==============================================================================
 void MultiFaderDroneAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+    // the engine is never read from here. The snapshot is the latest one the render thread published, and is left out if
+    // nothing has been rendered yet.
+    const juce::SpinLock::ScopedLockType lock(stateLock);
+    auto& snapshot = snapshotPending.load() ? loadedSnapshot : savedSnapshot;
+    jr::BinaryState::write(destData, apvts, snapshot.voices.empty() ? nullptr : &snapshot, &scenes, &scale, scaleDescription);
 }
 
 void MultiFaderDroneAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-    if (xmlState.get() != nullptr)
+    // the engine listeners are held off while the parameters change, so that the engine is updated once with every new value
+    // at the start of the next block, rather than once per parameter in whatever order they arrive
+    loadingState = true;
+    bool hasLoaded = false;
+
+    if (jr::BinaryState::isBinaryState(data, sizeInBytes))
     {
-        if (xmlState->hasTagName(apvts.state.getType()))
+        hasLoaded = jr::BinaryState::readParameters(data, sizeInBytes, apvts);
+    }
+    else
+    {
+        // sessions saved before the binary format were saved as XML
+        std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+        if (xmlState.get() != nullptr && xmlState->hasTagName(apvts.state.getType()))
         {
             apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+            hasLoaded = true;
+        }
+    }
+
+    loadingState = false;
+
+    if (hasLoaded)
+    {
+        scenes = {};
+        jr::BinaryState::readScenes(data, sizeInBytes, scenes);
+
+        // sessions without a scale go back to having none
+        jr::PitchTable::Scale loadedScale;
+        juce::String loadedDescription;
+        jr::BinaryState::readScale(data, sizeInBytes, loadedScale, loadedDescription);
+        {
+            const juce::SpinLock::ScopedLockType lock(stateLock);
+            scale = loadedScale;
+            scaleDescription = loadedDescription;
         }
+        faders.setScale(loadedScale);
+        frozenDrone.setScale(loadedScale);
+
+        const juce::SpinLock::ScopedLockType lock(stateLock);
+        settingsPending = true;
+        snapshotPending = jr::BinaryState::readSnapshot(data, sizeInBytes, loadedSnapshot);
+    }
+    else
+    {
+        // some parameters may have changed before the state turned out to be unreadable
+        settingsPending = true;
     }
 }
 
@@ -238,6 +691,28 @@ juce::AudioProcessorValueTreeState::ParameterLayout MultiFaderDroneAudioProcesso
     layout.add(std::make_unique<juce::AudioParameterFloat>(ID::FREQ_RANGE_MIN.toString(), "Frequency Range Min Value", minFreq, maxFreq, defaultMinFreq));
     layout.add(std::make_unique<juce::AudioParameterFloat>(ID::FREQ_RANGE_MAX.toString(), "Frequency Range Max Value", minFreq, maxFreq, defaultMaxFreq));
     layout.add(std::make_unique<juce::AudioParameterFloat>(ID::WAVE_SHAPE.toString(), "Wave Shape Modifier", 0.0f, 1.0f, 0.5f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ID::ENGINE.toString(), "Engine", juce::StringArray{ "Oscillators", "Spectral" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterInt>(ID::NUM_PARTIALS.toString(), "Partial Count", 100, maxPartialCount, 1000, "Partial Count"));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ID::FREEZE.toString(), "Freeze", false, "Freeze"));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ID::LOOKAHEAD.toString(), "Lookahead Render", false, "Lookahead Render"));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ID::LIMITER.toString(), "Output Limiter", false, "Output Limiter"));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ID::FADE_CURVE.toString(), "Voice Fade Curve", juce::StringArray{ "Linear", "Exponential", "Equal Power", "Raised Cosine" }, 3));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ID::MORPH_TIME.toString(), "Morph Time", juce::NormalisableRange<float>(0.1f, 60.0f, 0.0f, 0.4f), 8.0f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ID::PITCH_MODE.toString(), "Pitch Distribution", juce::StringArray{ "Linear", "Logarithmic", "Harmonic Series", "Just Intonation", "Equal Temperament", "Scala File" }, 0));
+    layout.add(std::make_unique<juce::AudioParameterInt>(ID::ROOT_NOTE.toString(), "Root Note", 12, 96, 36, "Root Note"));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ID::GLIDE_TIME.toString(), "Glide Time", juce::NormalisableRange<float>(0.01f, 10.0f, 0.0f, 0.4f), 0.5f));
+
+    // the other drone layers start silent, and are otherwise set up like the first
+    for (int layer{ 1 }; layer < FaderPairs::maxNumLayers; layer++)
+    {
+        juce::String name = "Layer " + juce::String(layer + 1) + " ";
+        layout.add(std::make_unique<juce::AudioParameterInt>(ID::getLayerID(ID::NUM_VOICES, layer), name + "Voice Count", 0, maxOscCount, 0, name + "Voice Count"));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ID::getLayerID(ID::RATE, layer), name + "Rate", 0.0f, 1.0f, 0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ID::getLayerID(ID::STEREO_WIDTH, layer), name + "Stereo Width", 0.0f, 1.0f, 0.5f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ID::getLayerID(ID::FREQ_RANGE_MIN, layer), name + "Frequency Range Min Value", minFreq, maxFreq, defaultMinFreq));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ID::getLayerID(ID::FREQ_RANGE_MAX, layer), name + "Frequency Range Max Value", minFreq, maxFreq, defaultMaxFreq));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(ID::getLayerID(ID::WAVE_SHAPE, layer), name + "Wave Shape Modifier", 0.0f, 1.0f, 0.5f));
+    }
 
     return layout;
 }
\ No newline at end of file
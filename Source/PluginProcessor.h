@@ -10,8 +10,18 @@
 
 #include <JuceHeader.h>
 #include <vector>
+#include <atomic>
+#include <array>
+#include <utility>
 #include "Components/Audio/jr_Oscillators.h"
 #include "Components/Audio/jr_FaderPairs.h"
+#include "Components/Audio/jr_FrozenDrone.h"
+#include "Components/Audio/jr_LookaheadRenderer.h"
+#include "Components/Audio/jr_AnalyserFifo.h"
+#include "Components/Audio/jr_OutputMeter.h"
+#include "Components/Audio/jr_Limiter.h"
+#include "Components/Audio/jr_BinaryState.h"
+#include "Components/Audio/jr_PresetMorph.h"
 #include "Components/Audio/ApvtsListener.h"
 
 // parameter IDs
@@ -26,12 +36,31 @@ namespace ID
     const juce::Identifier FREQ_RANGE_MAX{ "freqRangeMax" };
     const juce::Identifier DARK_MODE{ "darkMode" };
     const juce::Identifier WAVE_SHAPE{ "waveShape" };
+    const juce::Identifier ENGINE{ "engine" };
+    const juce::Identifier NUM_PARTIALS{ "numPartials" };
+    const juce::Identifier FREEZE{ "freeze" };
+    const juce::Identifier LOOKAHEAD{ "lookahead" };
+    const juce::Identifier LIMITER{ "limiter" };
+    const juce::Identifier MORPH_TIME{ "morphTime" };
+    const juce::Identifier FADE_CURVE{ "fadeCurve" };
+    const juce::Identifier PITCH_MODE{ "pitchMode" };
+    const juce::Identifier ROOT_NOTE{ "rootNote" };
+    const juce::Identifier GLIDE_TIME{ "glideTime" };
+
+    /*
+    Returns the ID of a parameter of the given drone layer. The first layer keeps the plain ID, so older sessions still load.
+    */
+    inline juce::String getLayerID(const juce::Identifier& id, int layer)
+    {
+        return layer == 0 ? id.toString() : id.toString() + juce::String(layer + 1);
+    }
 }
 
 //==============================================================================
 /**
 */
-class MultiFaderDroneAudioProcessor  : public juce::AudioProcessor
+class MultiFaderDroneAudioProcessor  : public juce::AudioProcessor,
+                                       private juce::Timer
 {
 public:
     //==============================================================================
@@ -73,22 +102,92 @@ public:
 
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    void setNumOscs(int _numOscs) { faders.setNumOscs(_numOscs); }
+    void setNumOscs(int layer, int _numOscs) { faders.setNumOscs(layer, _numOscs); }
     
-    void setLfoRate(float _rate) { faders.setLfoRate(jr::Utils::constrainFloat(_rate)); }
+    void setLfoRate(int layer, float _rate) { faders.setLfoRate(layer, jr::Utils::constrainFloat(_rate)); }
 
-    void setMinOscFreq(float minHz) { faders.setMinFreq(minHz); }
+    void setMinOscFreq(int layer, float minHz) { faders.setMinFreq(layer, minHz); }
 
-    void setMaxOscFreq(float maxHz) { faders.setMaxFreq(maxHz); }
+    void setMaxOscFreq(int layer, float maxHz) { faders.setMaxFreq(layer, maxHz); }
 
     /*
-    * Sets stereo width to a value between 0 - 1.0 where 1.0 is full stereo width and 0 is mono
+    * Sets stereo width of a layer to a value between 0 - 1.0 where 1.0 is full stereo width and 0 is mono
     */
-    void setStereoWidth(float width) { faders.setStereoWidth(jr::Utils::constrainFloat(width)); }
+    void setStereoWidth(int layer, float width) { faders.setStereoWidth(layer, jr::Utils::constrainFloat(width)); }
 
     void setGain(double _gain) { gain.setTargetValue(jr::Utils::constrainFloat(_gain) * maxGain); }
 
-    void setWaveShape(float _waveShape) { faders.setWaveShape(_waveShape); }
+    void setWaveShape(int layer, float _waveShape) { faders.setWaveShape(layer, _waveShape); }
+
+    void setNumPartials(int _numPartials) { faders.setNumPartials(_numPartials); }
+
+    /*
+    Sets the engine from the index of the engine parameter, 0=Oscillators 1=Spectral
+    */
+    void setEngine(int engineIndex) { faders.setEngine(engineIndex == 1 ? FaderPairs::Engine::spectral : FaderPairs::Engine::oscillators); }
+
+    /*
+    Sets the curve voices fade along from the index of the fade curve parameter
+    */
+    void setFadeCurve(int curveIndex) { faders.setFadeCurve((jr::VoiceFade::Curve)juce::jlimit(0, 3, curveIndex)); }
+
+    /*
+    Sets how voice frequencies are picked from the index of the pitch mode parameter
+    */
+    void setPitchMode(int modeIndex) { faders.setPitchMode((jr::PitchTable::Mode)juce::jlimit(0, (int)jr::PitchTable::Mode::scala, modeIndex)); }
+
+    void setRootNote(float note) { faders.setRootNote(note); }
+
+    void setGlideTime(float seconds) { faders.setGlideTime(seconds); }
+
+    /*
+    Reads a Scala file and uses it as the scale for the Scala pitch mode. Returns false, keeping the current scale, if the file
+    can't be read or isn't a valid scale. Call from the message thread.
+    */
+    bool loadScale(const juce::File& file);
+
+    /*
+    Returns the description of the loaded Scala scale, or an empty string if none has been loaded. Call from the message thread.
+    */
+    juce::String getScaleDescription();
+
+    void setFrozen(bool shouldFreeze) { frozenDrone.setEnabled(shouldFreeze); }
+
+    /*
+    Turns rendering on a background thread ahead of the audio callback on or off, and reports the resulting latency to the host
+    */
+    void setLookahead(bool shouldLookAhead)
+    {
+        renderer.setEnabled(shouldLookAhead);
+        updateLatency();
+    }
+
+    /*
+    Turns the output limiter on or off, and reports the resulting latency to the host
+    */
+    void setLimiter(bool shouldLimit)
+    {
+        limiter.setEnabled(shouldLimit);
+        updateLatency();
+    }
+
+    /*
+    Stores the current engine settings as the scene with the given index, to be morphed to later. Call from the message thread.
+    */
+    void storeScene(int sceneIndex);
+
+    /*
+    Morphs the engine to the scene with the given index over the morph time, and moves the parameters straight to the scene's
+    values. Does nothing if no scene has been stored there. Call from the message thread.
+    */
+    void morphToScene(int sceneIndex);
+
+    bool hasScene(int sceneIndex) const { return juce::isPositiveAndBelow(sceneIndex, jr::PresetMorph::numScenes) && scenes[(size_t)sceneIndex].isStored; }
+
+    /*
+    Returns the current value of every engine parameter. Reads the raw parameter values so is safe to call from any thread.
+    */
+    FaderPairs::Settings getSettings();
 
     float getMaxFreq() { return maxFreq; }
 
@@ -106,12 +205,38 @@ public:
 
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
-    std::shared_ptr<std::vector<FaderPairs::RandomOsc>> getOscs() { return faders.getOscs(); }
+    /*
+    Returns the buffer that telemetry frames are published to for the GUI. Only one reader may use it.
+    */
+    jr::TelemetryBuffer& getTelemetry() { return telemetry; }
+
+    /*
+    Returns the FIFO that a decimated copy of the output is pushed to for the GUI spectrum analyser. Only one reader may use it.
+    */
+    jr::AnalyserFifo& getAnalyserFifo() { return analyserFifo; }
+
+    /*
+    Returns the meter that measures the output of the plugin
+    */
+    const jr::OutputMeter& getOutputMeter() const { return outputMeter; }
+
+    /*
+    Returns the latest peak, RMS and short-term loudness of the output. Safe to call from any thread, with or without an editor open.
+    */
+    jr::OutputMeter::Levels getOutputLevels() const { return outputMeter.getLevels(); }
+
+    /*
+    Returns the bytes held by the tables and typefaces shared by every instance of the plugin. The figure is for the one
+    shared copy, so it should stay the same however many instances are loaded.
+    */
+    size_t getSharedResourceFootprint() const { return sharedResources->getMemoryFootprint(); }
 
 private:
     float maxGain = 0.75;
     FaderPairs faders;              // class containing all RandomOscs controlled by their own random faders
+    juce::SharedResourcePointer<jr::SharedResources> sharedResources;  // the store shared with every other instance, held here to report its size
     int maxOscCount{ 100 };
+    int maxPartialCount{ 8000 };    // max number of partials the spectral engine can play
     float maxFreq{ 2000.0f };       // max freq in Hz that Osc Freq slider can be set
     float minFreq{ 60.0f };         // min freq in Hz that Osc Freq slider can be set
     float defaultMinFreq{ 120.0f };
@@ -123,12 +248,148 @@ private:
     juce::AudioProcessorValueTreeState apvts;
 
     jr::ApvtsListener gainListener{ [&](float newValue) { setGain(newValue); } };
-    jr::ApvtsListener rateListener{ [&](float newValue) { setLfoRate(newValue); } };
-    jr::ApvtsListener voicesListener{ [&](float newValue) { setNumOscs(newValue); } };
-    jr::ApvtsListener stereoWidthListener{ [&](float newValue) { setStereoWidth(newValue); } };
-    jr::ApvtsListener minFreqRangeListener{ [&](float newValue) { setMinOscFreq(newValue); } };
-    jr::ApvtsListener maxFreqRangeListener{ [&](float newValue) { setMaxOscFreq(newValue); } };
-    jr::ApvtsListener waveShapeListener{ [&](float newValue) { setWaveShape(newValue); } };
+
+    // the parameters of each drone layer, with callbacks set in the constructor
+    struct LayerListeners
+    {
+        jr::ApvtsListener voices, rate, stereoWidth, minFreq, maxFreq, waveShape;
+    };
+    std::array<LayerListeners, FaderPairs::maxNumLayers> layerListeners;
+
+    jr::ApvtsListener engineListener{ [&](float newValue) { if (!loadingState) setEngine((int)newValue); } };
+    jr::ApvtsListener partialsListener{ [&](float newValue) { if (!loadingState) setNumPartials((int)newValue); } };
+    jr::ApvtsListener freezeListener{ [&](float newValue) { setFrozen(newValue > 0.5f); } };
+    jr::ApvtsListener lookaheadListener{ [&](float newValue) { setLookahead(newValue > 0.5f); } };
+    jr::ApvtsListener limiterListener{ [&](float newValue) { setLimiter(newValue > 0.5f); } };
+    jr::ApvtsListener fadeCurveListener{ [&](float newValue) { setFadeCurve((int)newValue); } };
+    jr::ApvtsListener pitchModeListener{ [&](float newValue) { if (!loadingState) setPitchMode((int)newValue); } };
+    jr::ApvtsListener rootNoteListener{ [&](float newValue) { if (!loadingState) setRootNote(newValue); } };
+    jr::ApvtsListener glideTimeListener{ [&](float newValue) { setGlideTime(newValue); } };
+    jr::ApvtsListener engineChangedListener{ [&](float) { onEngineParameterChanged(); } };
+
+    jr::FrozenDrone frozenDrone{ [&]() { return getSettings(); }, maxOscCount, maxPartialCount };
+    jr::LookaheadRenderer renderer{ [&](juce::AudioBuffer<float>& block) { renderBlock(block); } };
+
+    jr::TelemetryBuffer telemetry;
+    int telemetryInterval{ 1 };         // samples between telemetry frames
+    int samplesUntilTelemetry{ 0 };
+    static constexpr double telemetryRateHz{ 60.0 };
+
+    jr::AnalyserFifo analyserFifo;      // output for the spectrum analyser
+    jr::OutputMeter outputMeter;
+    jr::Limiter limiter;                // optional true-peak limiter at the end of the chain
+
+    // loaded settings and engine snapshots are handed between the audio and message threads under stateLock, which the audio
+    // thread only tries
+    std::atomic<bool> loadingState{ false };    // true while a state or scene is changing parameters, holding off the engine listeners
+    std::atomic<bool> settingsPending{ false }; // the parameters have been loaded, so the render thread should read them all and apply them in one go
+    FaderPairs::Snapshot savedSnapshot;         // the latest snapshot published by the render thread, for getStateInformation
+    FaderPairs::Snapshot loadedSnapshot;        // read by setStateInformation, to be restored by the audio thread
+    juce::SpinLock stateLock;
+    std::atomic<bool> snapshotPending{ false };
+
+    // the engine is only ever read by the thread that renders, which captures a snapshot every snapshotSeconds and swaps it
+    // into savedSnapshot when stateLock is free
+    FaderPairs::Snapshot capturedSnapshot;      // render thread only
+    bool snapshotUnpublished{ false };          // render thread only, true if capturedSnapshot is newer than savedSnapshot
+    int snapshotInterval{ 1 };                  // samples between snapshots
+    int samplesUntilSnapshot{ 0 };
+    static constexpr double snapshotSeconds{ 0.25 };
+
+    jr::PresetMorph morph;                      // audio thread only
+    jr::PresetMorph::Scenes scenes;             // message thread only
+    FaderPairs::Settings pendingMorphFrom;      // where the morph started at the next block begins, guarded by stateLock. It heads for the parameters.
+    double pendingMorphSeconds{ 0.0 };
+    std::atomic<bool> morphPending{ false };
+    std::atomic<bool> morphInterrupted{ false }; // an engine parameter was changed by hand, so a running morph should stop
+
+    jr::PitchTable::Scale scale;                // the loaded Scala scale, empty until one is loaded, guarded by stateLock
+    juce::String scaleDescription;              // the description line of the loaded Scala file, guarded by stateLock
+
+    // MIDI notes move the root, and are handed from processBlock to whichever thread is rendering through a FIFO
+    struct RootEvent
+    {
+        int note;                               // the note to move the root to, or -1 to go back to the root note parameter
+        int sampleOffset;                       // position in the block the event arrived in
+    };
+    static constexpr int maxRootEvents{ 256 };
+    juce::AbstractFifo rootEventFifo{ maxRootEvents };
+    std::array<RootEvent, maxRootEvents> rootEvents;
+    float rootTransposition{ 0.0f };            // semitones the root has been moved by, only used by the thread that renders
+    std::atomic<float> midiTransposition{ 0.0f };   // the same, for the message thread to pass on to the frozen drone
+    static constexpr int pitchTablePollMs{ 20 };    // how often the message thread checks for a pitch table to build
+
+    /*
+    Reports the total latency of the lookahead renderer and limiter, whichever are on, to the host
+    */
+    void updateLatency()
+    {
+        setLatencySamples((renderer.isEnabled() ? renderer.getLatencySamples() : 0) + (limiter.isEnabled() ? limiter.getLatencySamples() : 0));
+    }
+
+    /*
+    Renders the next block of the drone and publishes telemetry when it is due. Called from whichever thread is rendering.
+    */
+    void renderBlock(juce::AudioBuffer<float>& block);
+
+    /*
+    Renders numSamples of block starting at startSample. Called by renderBlock between MIDI events.
+    */
+    void renderSection(juce::AudioBuffer<float>& block, int startSample, int numSamples);
+
+    /*
+    Queues the note ons and all notes off messages in midi to be applied by renderBlock. Reads the raw bytes, so doesn't allocate.
+    */
+    void queueRootEvents(const juce::MidiBuffer& midi);
+
+    /*
+    Moves the root to note, gliding the voices there, or back to the root note parameter if note is -1. Called from whichever
+    thread is rendering. Voices that start afterwards get the new pitch straight away. The pitch tables and the frozen drone
+    catch up on the next timer tick, within pitchTablePollMs, unless the message thread is busy.
+    */
+    void applyRootEvent(int note);
+
+    /*
+    Builds the pitch table if the engine needs one and passes the MIDI transposition on to the frozen drone. Polled on the
+    message thread, so the thread that renders never has to post a message.
+    */
+    void timerCallback() override;
+
+    /*
+    Applies the settings and restores the snapshot loaded by setStateInformation, if the lock is free. Called from whichever
+    thread is rendering, before the engine is processed.
+    */
+    void exchangeState();
+
+    /*
+    Captures a snapshot of the engine every snapshotInterval samples, and hands the latest one over to getStateInformation
+    once the lock is free. Called from whichever thread is rendering, after the engine is processed.
+    */
+    void updateSnapshot(int numSamples);
+
+    /*
+    Drops out of freeze, and stops any morph if the change didn't come from a state load or morph
+    */
+    void onEngineParameterChanged();
+
+    /*
+    Sets every engine parameter to the value in settings, notifying the host, with the engine listeners held off
+    */
+    void setEngineParameters(const FaderPairs::Settings& settings);
+
+    /*
+    Steps a running morph, or stops it and moves the engine to the current parameter values if it has been interrupted.
+    Called from whichever thread is rendering.
+    */
+    void processMorph(int numSamples);
+
+    /*
+    Returns the ID of each parameter of a layer, paired with the listener that applies it
+    */
+    std::array<std::pair<juce::String, jr::ApvtsListener*>, 6> getLayerParameters(int layer);
+
+    // parameters that change the sound of the drone, and so invalidate a frozen loop, along with every layer parameter
+    const juce::Identifier engineParameterIDs[4]{ ID::ENGINE, ID::NUM_PARTIALS, ID::PITCH_MODE, ID::ROOT_NOTE };
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiFaderDroneAudioProcessor)
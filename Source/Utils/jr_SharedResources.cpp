@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    jr_SharedResources.cpp
+    Created: 19 Oct 2026 5:21:08pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#include "jr_SharedResources.h"
+#include "../LookAndFeel/Resources/FontResources.h"
+
+jr::SharedResources::SharedResources()
+{
+	sineTable.resize(sineTableSize + 1);
+	for (int i{}; i <= sineTableSize; i++)
+	{
+		sineTable[i] = (float)std::sin(juce::MathConstants<double>::twoPi * (double)i / (double)sineTableSize);
+	}
+}
+
+const jr::SharedResources::SpectralWindow& jr::SharedResources::getSpectralWindow(int fftSize, int hopSize, int lobeHalfWidth, int lobeResolution) const
+{
+	const juce::ScopedLock lock(spectralWindowLock);
+	if (!spectralWindow.lobe.empty())
+	{
+		jassert(spectralWindow.lobe.size() == (size_t)(2 * lobeHalfWidth * lobeResolution + 1) && spectralWindow.synthesis.size() == (size_t)(2 * hopSize));
+		return spectralWindow;
+	}
+
+	// Blackman-Harris window centred in the frame. Its sidelobes are low enough that drawing only the
+	// main lobe of each partial gives a windowed sinusoid after the inverse FFT.
+	std::vector<double> window(fftSize);
+	for (int n{}; n < fftSize; n++)
+	{
+		auto x = juce::MathConstants<double>::twoPi * (double)n / (double)fftSize;
+		window[n] = 0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) - 0.01168 * std::cos(3.0 * x);
+	}
+
+	auto& lobe = spectralWindow.lobe;
+	lobe.resize(2 * lobeHalfWidth * lobeResolution + 1);
+	for (size_t i{}; i < lobe.size(); i++)
+	{
+		auto distance = (double)i / (double)lobeResolution - (double)lobeHalfWidth;
+		double sum{};
+		for (int n{}; n < fftSize; n++)
+		{
+			sum += window[n] * std::cos(juce::MathConstants<double>::twoPi * distance * (double)(n - fftSize / 2) / (double)fftSize);
+		}
+		lobe[i] = (float)sum;
+	}
+
+	// divide out the Blackman-Harris window and replace it with triangles that overlap-add to 1
+	auto& synthesis = spectralWindow.synthesis;
+	synthesis.resize(2 * hopSize);
+	for (int i{}; i < 2 * hopSize; i++)
+	{
+		int n = fftSize / 2 - hopSize + i;
+		auto triangle = 1.0 - std::abs((double)(n - fftSize / 2)) / (double)hopSize;
+		synthesis[i] = (float)(triangle / window[n]);
+	}
+
+	return spectralWindow;
+}
+
+juce::Typeface::Ptr jr::SharedResources::getBoldTypeface() const
+{
+	const juce::ScopedLock lock(typefaceLock);
+	if (boldTypeface == nullptr)
+	{
+		boldTypeface = juce::Typeface::createSystemTypefaceFor(Resources::WorkSansSemiBold_ttf, Resources::WorkSansSemiBold_ttfSize);
+	}
+	return boldTypeface;
+}
+
+juce::Typeface::Ptr jr::SharedResources::getPlainTypeface() const
+{
+	const juce::ScopedLock lock(typefaceLock);
+	if (plainTypeface == nullptr)
+	{
+		plainTypeface = juce::Typeface::createSystemTypefaceFor(Resources::WorkSansRegular_ttf, Resources::WorkSansRegular_ttfSize);
+	}
+	return plainTypeface;
+}
+
+size_t jr::SharedResources::getMemoryFootprint() const
+{
+	size_t bytes = sizeof(*this) + sineTable.capacity() * sizeof(float);
+
+	{
+		const juce::ScopedLock lock(spectralWindowLock);
+		bytes += (spectralWindow.lobe.capacity() + spectralWindow.synthesis.capacity()) * sizeof(float);
+	}
+
+	// each typeface is made from a copy of its font file, which it keeps for as long as it exists
+	const juce::ScopedLock lock(typefaceLock);
+	if (boldTypeface != nullptr)
+	{
+		bytes += (size_t)Resources::WorkSansSemiBold_ttfSize;
+	}
+	if (plainTypeface != nullptr)
+	{
+		bytes += (size_t)Resources::WorkSansRegular_ttfSize;
+	}
+
+	return bytes;
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    jr_SharedResources.h
+    Created: 19 Oct 2026 5:21:08pm
+    Author:  ridle
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+#include <vector>
+
+namespace jr
+{
+	/*
+	Read-only tables and decoded assets that are the same for every instance of the plugin. Use through a
+	juce::SharedResourcePointer<SharedResources>: the store is built when the first pointer is created and freed when the
+	last one is destroyed, so every instance in a session shares one copy. Nothing can be changed from outside, so it is
+	safe to read from any thread.
+
+	Typefaces are only decoded the first time they are asked for, so instances that never open an editor never pay for them.
+	*/
+	class SharedResources
+	{
+	public:
+		SharedResources();
+
+		static constexpr int sineTableSize = 4096;
+
+		/*
+		Returns the sine of phase, where phase is in cycles (1 = one full cycle). Any phase value can be used.
+		*/
+		float sine(float phase) const
+		{
+			auto position = (phase - std::floor(phase)) * (float)sineTableSize;
+			auto index = juce::jmin((int)position, sineTableSize - 1);
+			auto fraction = position - (float)index;
+			return sineTable[index] + (sineTable[index + 1] - sineTable[index]) * fraction;
+		}
+
+		/*
+		Returns the cosine of phase, where phase is in cycles
+		*/
+		float cosine(float phase) const { return sine(phase + 0.25f); }
+
+		/*
+		Equal power pan law, returns the gain of a side that is the given proportion (0 - 1) of the way towards fully on
+		*/
+		float getEqualPowerGain(float proportion) const { return sine(0.25f * juce::jlimit(0.0f, 1.0f, proportion)); }
+
+		/*
+		The analysis lobe and synthesis window of the spectral engine, which only depend on its frame sizes
+		*/
+		struct SpectralWindow
+		{
+			std::vector<float> lobe;			// Blackman-Harris spectrum from -lobeHalfWidth to +lobeHalfWidth bins
+			std::vector<float> synthesis;		// triangle / Blackman-Harris, applied to the centre 2 * hopSize samples of each frame
+		};
+
+		/*
+		Returns the spectral engine's window tables, building them on the first call. Every call has to ask for the same sizes.
+		The first call takes a while, so it shouldn't be made from the audio thread.
+		*/
+		const SpectralWindow& getSpectralWindow(int fftSize, int hopSize, int lobeHalfWidth, int lobeResolution) const;
+
+		/*
+		Returns the bold WorkSans typeface, decoding it on the first call
+		*/
+		juce::Typeface::Ptr getBoldTypeface() const;
+
+		/*
+		Returns the regular WorkSans typeface, decoding it on the first call
+		*/
+		juce::Typeface::Ptr getPlainTypeface() const;
+
+		/*
+		Returns the number of bytes the store holds: the store itself, the sine table, the spectral window tables once built, and
+		the copy of the font file that each decoded typeface keeps. Doesn't include the glyph outlines and caches that the
+		platform's font engine builds as text is drawn, which aren't reported, or the embedded font files, which are part of
+		the plugin binary.
+		*/
+		size_t getMemoryFootprint() const;
+
+	private:
+		std::vector<float> sineTable;					// one cycle of sine, with the first point repeated at the end for interpolation
+		juce::CriticalSection typefaceLock;				// held while a typeface is being decoded
+		mutable juce::Typeface::Ptr boldTypeface;		// decoded on first use
+		mutable juce::Typeface::Ptr plainTypeface;		// decoded on first use
+		juce::CriticalSection spectralWindowLock;		// held while the spectral window is being built
+		mutable SpectralWindow spectralWindow;			// built on first use
+	};
+}